@@ -0,0 +1,133 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Результат выделения «не меньше n» (аналог std::allocation_result из C++23)
+template <typename Pointer>
+struct AllocationResult {
+    Pointer ptr;
+    size_t count;
+};
+
+// Аллокатор поверх malloc/realloc/free. Благодаря reallocate вектор тривиально
+// перемещаемых элементов растёт через realloc: часто на месте, без копирования
+template <typename T>
+class MallocAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc cannot satisfy alignment of T");
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        void* p = std::malloc(BytesFor(n));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    // malloc округляет запрос до своего класса размеров; этот запас отдаётся вектору как вместимость
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        return AtLeast(allocate(n), n);
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        std::free(p);
+    }
+
+    // Как и allocate_at_least, отдаёт вектору весь блок, который вернул realloc
+    AllocationResult<T*> reallocate(T* p, size_t, size_t new_n) {
+        void* result = std::realloc(static_cast<void*>(p), BytesFor(new_n));
+        if (result == nullptr) {
+            throw std::bad_alloc();
+        }
+        return AtLeast(static_cast<T*>(result), new_n);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t BytesFor(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static AllocationResult<T*> AtLeast(T* p, [[maybe_unused]] size_t n) noexcept {
+#if defined(__GLIBC__)
+        return {p, malloc_usable_size(p) / sizeof(T)};
+#else
+        return {p, n};
+#endif
+    }
+};
+
+// Аллокатор с выравниванием буфера не меньше Alignment байт (и не меньше alignof(T)):
+// кеш-линия, чтобы векторы разных потоков не делили линию, или ширина SIMD-регистра,
+// чтобы векторизованные циклы обходились без пролога и эпилога
+template <typename T, size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static constexpr size_t kAlignment = Alignment > alignof(T) ? Alignment : alignof(T);
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{kAlignment}));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        operator delete(p, n * sizeof(T), std::align_val_t{kAlignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <memory_resource>
+
+// Монотонный ресурс памяти: выделение — сдвиг указателя внутри текущего блока,
+// освобождение отдельных кусков ничего не стоит, а вся память возвращается разом
+// в Release() или в деструкторе. Рассчитан на короткоживущие векторы одного запроса:
+//
+//     MonotonicArena arena;
+//     pmr::Vector<int> v(&arena);
+//
+// В отличие от std::pmr::monotonic_buffer_resource, освобождение последнего выделенного
+// куска откатывает указатель: временный вектор, уничтоженный до следующего выделения
+// (освобождение в порядке стека), возвращает свою память блоку. Рост вектора этим не
+// пользуется — новый буфер выделяется раньше, чем освобождается старый, и старый к тому
+// моменту уже не последний.
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    explicit MonotonicArena(size_t initial_block_size = 4096,
+                            std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream_(upstream)
+        , initial_block_size_(initial_block_size < kMinBlockSize ? kMinBlockSize : initial_block_size)
+        , next_block_size_(initial_block_size_) {
+    }
+
+    // Первым блоком служит внешний буфер (например, на стеке); арена им не владеет
+    MonotonicArena(void* buffer, size_t size,
+                   std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : MonotonicArena(size, upstream) {
+        initial_buffer_ = static_cast<std::byte*>(buffer);
+        initial_size_ = size;
+        current_ = initial_buffer_;
+        end_ = initial_buffer_ + initial_size_;
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() override {
+        Release();
+    }
+
+    // Возвращает вышестоящему ресурсу все блоки. Память, выданная ранее, становится недействительной.
+    // Размер следующего блока сбрасывается к начальному, чтобы арена, переиспользуемая в цикле,
+    // не удваивала блоки без ограничения
+    void Release() noexcept {
+        while (blocks_ != nullptr) {
+            BlockHeader* next = blocks_->next;
+            upstream_->deallocate(blocks_, blocks_->size, alignof(BlockHeader));
+            blocks_ = next;
+        }
+        current_ = initial_buffer_;
+        end_ = initial_buffer_ + initial_size_;
+        next_block_size_ = initial_block_size_;
+        bytes_allocated_ = 0;
+    }
+
+    // Суммарный объём выданной (и ещё не откатанной) памяти
+    size_t BytesAllocated() const noexcept {
+        return bytes_allocated_;
+    }
+
+    std::pmr::memory_resource* GetUpstream() const noexcept {
+        return upstream_;
+    }
+
+private:
+    struct BlockHeader {
+        BlockHeader* next;
+        size_t size;
+    };
+
+    static constexpr size_t kMinBlockSize = 256;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        // Сравниваем размеры, а не указатели: указатель за концом блока не формируем вовсе
+        size_t padding = Padding(current_, alignment);
+        const size_t available = static_cast<size_t>(end_ - current_);
+        if (current_ == nullptr || padding > available || bytes > available - padding) {
+            AddBlock(bytes, alignment);
+            padding = Padding(current_, alignment);
+        }
+        std::byte* result = current_ + padding;
+        current_ = result + bytes;
+        bytes_allocated_ += bytes;
+        return result;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t) override {
+        // Откатываем только последний кусок, остальное живёт до Release()
+        auto* ptr = static_cast<std::byte*>(p);
+        if (ptr + bytes == current_) {
+            current_ = ptr;
+            bytes_allocated_ -= bytes;
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    // Сколько байт пропустить, чтобы ptr стал выровнен на alignment
+    static size_t Padding(const std::byte* ptr, size_t alignment) noexcept {
+        auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        return static_cast<size_t>(-address & (static_cast<std::uintptr_t>(alignment) - 1));
+    }
+
+    void AddBlock(size_t bytes, size_t alignment) {
+        if (bytes > std::numeric_limits<size_t>::max() - sizeof(BlockHeader) - alignment) {
+            throw std::bad_alloc();
+        }
+        size_t block_size = next_block_size_;
+        const size_t required = sizeof(BlockHeader) + bytes + alignment;
+        while (block_size < required) {
+            block_size = block_size > std::numeric_limits<size_t>::max() / 2 ? required : block_size * 2;
+        }
+        auto* block = static_cast<BlockHeader*>(upstream_->allocate(block_size, alignof(BlockHeader)));
+        block->next = blocks_;
+        block->size = block_size;
+        blocks_ = block;
+
+        current_ = reinterpret_cast<std::byte*>(block + 1);
+        end_ = reinterpret_cast<std::byte*>(block) + block_size;
+        next_block_size_ = block_size * 2;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t initial_block_size_;
+    size_t next_block_size_;
+    BlockHeader* blocks_ = nullptr;
+    std::byte* initial_buffer_ = nullptr;
+    size_t initial_size_ = 0;
+    std::byte* current_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t bytes_allocated_ = 0;
+};
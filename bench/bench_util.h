@@ -0,0 +1,190 @@
+#pragma once
+// Общие средства бенчмарков: таймер, подсчёт выделений памяти, пиковый RSS и вывод
+// результатов в формате JSON Lines (одна запись на строку).
+//
+// Заголовок заменяет глобальные operator new/delete, поэтому в каждую программу-бенчмарк
+// он включается ровно из одной единицы трансляции.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+inline std::atomic<size_t> g_allocations{0};
+inline std::atomic<size_t> g_allocated_bytes{0};
+
+inline size_t Allocations() noexcept {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+inline size_t AllocatedBytes() noexcept {
+    return g_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+// Сбрасывает пиковый RSS процесса (Linux 4.0+); без поддержки пик считается с начала работы
+inline void ResetPeakRss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+}
+
+inline size_t PeakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// Не даёт компилятору выбросить вычисления, результат которых не используется
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Measurement {
+    double ns_per_op = 0;
+    double allocs_per_op = 0;
+    size_t peak_rss_kb = 0;
+};
+
+// Запускает body(ops) repetitions раз и берёт лучшее время. body возвращает
+// число выполненных операций
+template <typename Body>
+Measurement Measure(int repetitions, Body body) {
+    Measurement best;
+    best.ns_per_op = -1;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        ResetPeakRss();
+        const size_t allocations_before = Allocations();
+        const auto start = std::chrono::steady_clock::now();
+        const size_t ops = body();
+        const auto finish = std::chrono::steady_clock::now();
+        const size_t allocations = Allocations() - allocations_before;
+
+        const double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+        const double ns_per_op = ops == 0 ? 0 : ns / static_cast<double>(ops);
+        if (best.ns_per_op < 0 || ns_per_op < best.ns_per_op) {
+            best.ns_per_op = ns_per_op;
+            best.allocs_per_op = ops == 0 ? 0 : static_cast<double>(allocations) / static_cast<double>(ops);
+        }
+        best.peak_rss_kb = std::max(best.peak_rss_kb, PeakRssKb());
+    }
+    return best;
+}
+
+struct Field {
+    std::string key;
+    std::string value;
+    bool quoted;
+};
+
+inline Field Str(std::string key, std::string value) {
+    return {std::move(key), std::move(value), true};
+}
+
+inline Field Num(std::string key, double value) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.6g", value);
+    return {std::move(key), buf, false};
+}
+
+// Печатает одну запись JSON Lines
+inline void Report(const std::vector<Field>& fields) {
+    std::string line = "{";
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i != 0) {
+            line += ", ";
+        }
+        line += '"' + fields[i].key + "\": ";
+        line += fields[i].quoted ? '"' + fields[i].value + '"' : fields[i].value;
+    }
+    line += "}\n";
+    std::fputs(line.c_str(), stdout);
+    std::fflush(stdout);
+}
+
+inline void Report(const std::string& benchmark, const std::vector<Field>& params, const Measurement& m) {
+    std::vector<Field> fields{Str("benchmark", benchmark)};
+    fields.insert(fields.end(), params.begin(), params.end());
+    fields.push_back(Num("ns_per_op", m.ns_per_op));
+    fields.push_back(Num("allocs_per_op", m.allocs_per_op));
+    fields.push_back(Num("peak_rss_kb", static_cast<double>(m.peak_rss_kb)));
+    Report(fields);
+}
+
+}  // namespace bench
+
+#if defined(__GNUC__) && !defined(__clang__)
+// operator new ниже сам выделяет память через malloc, так что free в operator delete корректен
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    bench::g_allocations.fetch_add(1, std::memory_order_relaxed);
+    bench::g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    bench::g_allocations.fetch_add(1, std::memory_order_relaxed);
+    bench::g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc требует размер, кратный выравниванию
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,97 @@
+// Поток короткоживущих векторов: каждый «запрос» создаёт несколько временных Vector
+// случайного размера, заполняет их через PushBack (со всеми ступенями роста) и уничтожает.
+// Сравниваются std::allocator (operator new поверх malloc), MallocAllocator (malloc с
+// allocate_at_least и realloc) и CachingAllocator (кеш буферов потока).
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/buffer_cache_bench.cpp -o buffer_cache_bench -pthread
+//     ./buffer_cache_bench [число запросов на поток] [число потоков] > buffer_cache.jsonl
+//
+// Поведение аллокатора в стиле jemalloc (кеш потока с классами размеров) даёт запуск того же
+// бинарника с LD_PRELOAD=libjemalloc.so: тогда строки std::allocator и MallocAllocator
+// показывают jemalloc. Каждая строка вывода — JSON-объект с полями benchmark, allocator,
+// threads, requests, ns_per_op (время на один временный вектор), allocs_per_op (вызовы
+// operator new; MallocAllocator зовёт malloc напрямую и всегда показывает 0),
+// peak_rss_kb и hit_rate (только для CachingAllocator, по первому потоку).
+#include "bench_util.h"
+#include "buffer_cache.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+constexpr size_t kVectorsPerRequest = 8;
+constexpr uint64_t kMaxElements = 256;
+
+uint64_t SplitMix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+template <typename Alloc>
+uint64_t Churn(size_t requests, uint64_t seed) {
+    uint64_t sum = 0;
+    for (size_t request = 0; request < requests; ++request) {
+        // Временные векторы живут одновременно, как буферы одного обработчика запроса
+        Vector<uint64_t, Alloc> vectors[kVectorsPerRequest];
+        for (auto& v : vectors) {
+            seed = SplitMix(seed);
+            // Смещение к маленьким размерам, как у типичных временных буферов
+            const uint64_t elements = (seed % kMaxElements) >> (seed >> 60);
+            for (uint64_t i = 0; i < elements; ++i) {
+                v.PushBack(i);
+            }
+            sum += v.Size();
+        }
+    }
+    return sum;
+}
+
+template <typename Alloc>
+void Run(const char* name, size_t requests, size_t threads) {
+    const bench::Measurement m = bench::Measure(3, [&] {
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; ++t) {
+            workers.emplace_back([requests, t] {
+                bench::DoNotOptimize(Churn<Alloc>(requests, t));
+            });
+        }
+        bench::DoNotOptimize(Churn<Alloc>(requests, 0));
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return requests * threads * kVectorsPerRequest;
+    });
+
+    std::vector<bench::Field> fields{
+        bench::Str("benchmark", "Churn"),
+        bench::Str("allocator", name),
+        bench::Num("threads", static_cast<double>(threads)),
+        bench::Num("requests", static_cast<double>(requests)),
+        bench::Num("ns_per_op", m.ns_per_op),
+        bench::Num("allocs_per_op", m.allocs_per_op),
+        bench::Num("peak_rss_kb", static_cast<double>(m.peak_rss_kb)),
+    };
+    if constexpr (std::is_same_v<Alloc, CachingAllocator<uint64_t>>) {
+        fields.push_back(bench::Num("hit_rate", BufferCache::Local().Stats().HitRate()));
+        BufferCache::Local().ResetStats();
+    }
+    bench::Report(fields);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t requests = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+    const size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    Run<std::allocator<uint64_t>>("std::allocator", requests, threads);
+    Run<MallocAllocator<uint64_t>>("MallocAllocator", requests, threads);
+    Run<CachingAllocator<uint64_t>>("CachingAllocator", requests, threads);
+}
@@ -0,0 +1,81 @@
+// Пропускная способность добавления из нескольких потоков: ConcurrentVector против
+// Vector под std::mutex.
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/concurrent_vector_bench.cpp -o concurrent_vector_bench
+//     ./concurrent_vector_bench [число элементов на поток] > concurrent.jsonl
+//
+// Каждая строка вывода — JSON-объект с полями benchmark, container, threads,
+// per_thread, ns_per_op (время на один добавленный элемент по всем потокам),
+// allocs_per_op и peak_rss_kb.
+#include "bench_util.h"
+#include "concurrent_vector.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct LockedVector {
+    static constexpr const char* kName = "Vector+mutex";
+
+    void PushBack(uint64_t value) {
+        std::lock_guard guard(mutex);
+        data.PushBack(value);
+    }
+
+    std::mutex mutex;
+    Vector<uint64_t> data;
+};
+
+struct LockFreeVector {
+    static constexpr const char* kName = "ConcurrentVector";
+
+    void PushBack(uint64_t value) {
+        data.PushBack(value);
+    }
+
+    ConcurrentVector<uint64_t> data;
+};
+
+template <typename Container>
+void Run(size_t threads, size_t per_thread, int repetitions) {
+    bench::Report("ParallelPushBack",
+                  {
+                      bench::Str("container", Container::kName),
+                      bench::Num("threads", static_cast<double>(threads)),
+                      bench::Num("per_thread", static_cast<double>(per_thread)),
+                  },
+                  bench::Measure(repetitions, [&] {
+                      Container container;
+                      std::vector<std::thread> workers;
+                      for (size_t t = 0; t < threads; ++t) {
+                          workers.emplace_back([&container, t, per_thread] {
+                              for (size_t i = 0; i < per_thread; ++i) {
+                                  container.PushBack(t * per_thread + i);
+                              }
+                          });
+                      }
+                      for (auto& worker : workers) {
+                          worker.join();
+                      }
+                      bench::DoNotOptimize(container.data);
+                      return threads * per_thread;
+                  }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t per_thread = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const int repetitions = 5;
+    const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    for (size_t threads = 1; threads <= max_threads * 2; threads *= 2) {
+        Run<LockFreeVector>(threads, per_thread, repetitions);
+        Run<LockedVector>(threads, per_thread, repetitions);
+    }
+}
@@ -0,0 +1,127 @@
+// FlatMap против std::map и std::unordered_map: поиск случайных ключей (половина
+// отсутствует) и пакетная вставка 1% новых ключей в готовую таблицу.
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/flat_map_bench.cpp -o flat_map_bench
+//     ./flat_map_bench [число ключей ...] > flat_map.jsonl
+//
+// По умолчанию — от 1K до 10M ключей; 100M (./flat_map_bench 100000000) требует около
+// 12 ГБ памяти на std::map. Каждая строка вывода — JSON-объект с полями benchmark,
+// container, keys, ns_per_op, allocs_per_op и peak_rss_kb.
+#include "bench_util.h"
+#include "flat_map.h"
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t kLookups = 1'000'000;
+
+uint64_t SplitMix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Ключи таблицы — SplitMix от чётных чисел, отсутствующие — от нечётных
+uint64_t Key(size_t i, bool present) {
+    return SplitMix(2 * i + (present ? 0 : 1));
+}
+
+std::vector<uint64_t> Probes(size_t keys) {
+    std::vector<uint64_t> probes(kLookups);
+    for (size_t i = 0; i < kLookups; ++i) {
+        probes[i] = Key(SplitMix(i) % keys, i % 2 == 0);
+    }
+    return probes;
+}
+
+template <typename Find>
+void RunLookup(const char* name, size_t keys, const std::vector<uint64_t>& probes, Find find) {
+    bench::Report("Lookup", {bench::Str("container", name), bench::Num("keys", static_cast<double>(keys))},
+                  bench::Measure(3, [&] {
+                      uint64_t sum = 0;
+                      for (uint64_t probe : probes) {
+                          sum += find(probe);
+                      }
+                      bench::DoNotOptimize(sum);
+                      return probes.size();
+                  }));
+}
+
+template <typename Table>
+void RunBatchInsert(const char* name, size_t keys, const Table& table, const Vector<std::pair<uint64_t, uint64_t>>& batch) {
+    // Один замер: копия таблицы готовится заранее и в время не входит
+    Table copy = table;
+    bench::Report("BatchInsert", {bench::Str("container", name), bench::Num("keys", static_cast<double>(keys))},
+                  bench::Measure(1, [&] {
+                      if constexpr (requires { copy.Insert(batch.begin(), batch.end()); }) {
+                          copy.Insert(batch.begin(), batch.end());
+                      } else {
+                          copy.insert(batch.begin(), batch.end());
+                      }
+                      bench::DoNotOptimize(copy);
+                      return batch.Size();
+                  }));
+}
+
+void Run(size_t keys) {
+    Vector<std::pair<uint64_t, uint64_t>> entries;
+    entries.Reserve(keys);
+    for (size_t i = 0; i < keys; ++i) {
+        entries.EmplaceBack(Key(i, true), i);
+    }
+    const std::vector<uint64_t> probes = Probes(keys);
+    Vector<std::pair<uint64_t, uint64_t>> batch;
+    for (size_t i = 0; i < keys / 100 + 1; ++i) {
+        batch.EmplaceBack(Key(i, false), i);
+    }
+
+    {
+        FlatMap<uint64_t, uint64_t> flat(entries);
+        const auto find = [&](uint64_t key) {
+            const uint64_t* value = flat.Find(key);
+            return value == nullptr ? 0 : *value;
+        };
+        RunLookup("FlatMap", keys, probes, find);
+        RunBatchInsert("FlatMap", keys, flat, batch);
+        flat.SetSearchLayout(SearchLayout::kEytzinger);
+        RunLookup("FlatMap/Eytzinger", keys, probes, find);
+    }
+    {
+        std::map<uint64_t, uint64_t> tree(entries.begin(), entries.end());
+        RunLookup("std::map", keys, probes, [&](uint64_t key) {
+            const auto it = tree.find(key);
+            return it == tree.end() ? 0 : it->second;
+        });
+        RunBatchInsert("std::map", keys, tree, batch);
+    }
+    {
+        std::unordered_map<uint64_t, uint64_t> hash(entries.begin(), entries.end());
+        RunLookup("std::unordered_map", keys, probes, [&](uint64_t key) {
+            const auto it = hash.find(key);
+            return it == hash.end() ? 0 : it->second;
+        });
+        RunBatchInsert("std::unordered_map", keys, hash, batch);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {1'000, 10'000, 100'000, 1'000'000, 10'000'000};
+    }
+    for (size_t keys : sizes) {
+        Run(keys);
+    }
+}
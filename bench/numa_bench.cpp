@@ -0,0 +1,82 @@
+// Пропускная способность памяти при разном размещении буфера по узлам NUMA:
+// поток, закреплённый за узлом cpu_node, читает и пишет Vector<uint64_t>, страницы которого
+// привязаны к узлу memory (local/remote), чередуются по узлам (interleave)
+// или размещены первым касанием этого потока (first_touch).
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/numa_bench.cpp -o numa_bench
+//     ./numa_bench [размер в МиБ] > numa.jsonl
+//
+// На машине с одним узлом выводятся только локальные измерения.
+#include "bench_util.h"
+#include "numa_allocator.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using NumaVector = Vector<uint64_t, NumaAllocator<uint64_t>>;
+
+void RunPlacement(int cpu_node, const std::string& memory, NumaPolicy policy, size_t size, int repetitions) {
+    NumaVector v(size, kDefaultInit, NumaAllocator<uint64_t>(policy));
+    // Первая запись размещает страницы согласно политике
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = i;
+    }
+    const int first_page_node = NumaNodeOf(&v[0]);
+
+    const auto report = [&](const char* benchmark, const bench::Measurement& m) {
+        const double bytes_per_ns = m.ns_per_op == 0 ? 0 : sizeof(uint64_t) / m.ns_per_op;
+        bench::Report(benchmark,
+                      {
+                          bench::Num("cpu_node", cpu_node),
+                          bench::Str("memory", memory),
+                          bench::Num("first_page_node", first_page_node),
+                          bench::Num("size_mb", static_cast<double>(size * sizeof(uint64_t) >> 20)),
+                          bench::Num("gb_per_s", bytes_per_ns),
+                      },
+                      m);
+    };
+
+    report("Read", bench::Measure(repetitions, [&] {
+        uint64_t sum = 0;
+        for (uint64_t value : v) {
+            sum += value;
+        }
+        bench::DoNotOptimize(sum);
+        return size;
+    }));
+
+    report("Write", bench::Measure(repetitions, [&] {
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = size - i;
+        }
+        bench::DoNotOptimize(v[0]);
+        return size;
+    }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+    const size_t size = (megabytes << 20) / sizeof(uint64_t);
+    const int repetitions = 5;
+
+    const std::vector<int>& nodes = NumaNodes();
+    for (int cpu_node : nodes) {
+        BindThreadToNode(cpu_node);
+        for (int memory_node : nodes) {
+            const std::string memory = (memory_node == cpu_node ? "local node " : "remote node ")
+                                       + std::to_string(memory_node);
+            RunPlacement(cpu_node, memory, NumaPolicy::Bind(memory_node), size, repetitions);
+        }
+        if (nodes.size() > 1) {
+            RunPlacement(cpu_node, "interleave", NumaPolicy::Interleave(), size, repetitions);
+        }
+        RunPlacement(cpu_node, "first_touch", NumaPolicy::FirstTouch(), size, repetitions);
+    }
+}
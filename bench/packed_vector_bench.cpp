@@ -0,0 +1,130 @@
+// Упакованные векторы против Vector: сумма столбца (PackedIntVector — через Decode
+// блоками по 1024 значения), случайный доступ и подсчёт флагов (BitVector::Count против
+// Vector<bool>).
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/packed_vector_bench.cpp -o packed_vector_bench
+//     ./packed_vector_bench [число элементов] > packed.jsonl
+//
+// Каждая строка вывода — JSON-объект с полями benchmark, container, elements,
+// bytes_per_element, ns_per_op, allocs_per_op и peak_rss_kb.
+#include "bench_util.h"
+#include "packed_vector.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr size_t kChunk = 1024;
+constexpr size_t kRandomReads = 10'000'000;
+
+uint64_t SplitMix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+void Report(const char* benchmark, const std::string& container, size_t elements, double bytes,
+            const bench::Measurement& m) {
+    bench::Report(benchmark,
+                  {bench::Str("container", container), bench::Num("elements", static_cast<double>(elements)),
+                   bench::Num("bytes_per_element", bytes / static_cast<double>(elements))},
+                  m);
+}
+
+template <typename Get>
+bench::Measurement MeasureRandom(size_t elements, Get get) {
+    return bench::Measure(3, [&] {
+        uint64_t sum = 0;
+        uint64_t state = 0;
+        for (size_t i = 0; i < kRandomReads; ++i) {
+            state = SplitMix(state);
+            sum += get(state % elements);
+        }
+        bench::DoNotOptimize(sum);
+        return kRandomReads;
+    });
+}
+
+template <size_t Bits>
+void RunPacked(size_t elements) {
+    PackedIntVector<Bits> packed;
+    packed.Reserve(elements);
+    for (size_t i = 0; i < elements; ++i) {
+        packed.PushBack(static_cast<uint32_t>(SplitMix(i) & packed_detail::LowMask(Bits)));
+    }
+    const std::string name = "PackedIntVector<" + std::to_string(Bits) + ">";
+    const double bytes = static_cast<double>(elements * Bits) / 8;
+
+    Report("Scan", name, elements, bytes, bench::Measure(5, [&] {
+               uint32_t chunk[kChunk];
+               uint64_t sum = 0;
+               for (size_t first = 0; first < elements; first += kChunk) {
+                   const size_t count = std::min(kChunk, elements - first);
+                   packed.Decode(first, count, chunk);
+                   for (size_t i = 0; i < count; ++i) {
+                       sum += chunk[i];
+                   }
+               }
+               bench::DoNotOptimize(sum);
+               return elements;
+           }));
+    Report("RandomAccess", name, elements, bytes, MeasureRandom(elements, [&](size_t i) {
+               return std::as_const(packed)[i];
+           }));
+}
+
+void Run(size_t elements) {
+    Vector<uint32_t> plain;
+    plain.Reserve(elements);
+    for (size_t i = 0; i < elements; ++i) {
+        plain.PushBack(static_cast<uint32_t>(SplitMix(i) & 0xFFFF));
+    }
+    Report("Scan", "Vector<uint32_t>", elements, 4.0 * elements, bench::Measure(5, [&] {
+               uint64_t sum = 0;
+               for (uint32_t value : plain) {
+                   sum += value;
+               }
+               bench::DoNotOptimize(sum);
+               return elements;
+           }));
+    Report("RandomAccess", "Vector<uint32_t>", elements, 4.0 * elements, MeasureRandom(elements, [&](size_t i) {
+               return plain[i];
+           }));
+
+    RunPacked<8>(elements);
+    RunPacked<17>(elements);
+    RunPacked<32>(elements);
+
+    Vector<bool> flags;
+    BitVector bits;
+    for (size_t i = 0; i < elements; ++i) {
+        const bool value = SplitMix(i) % 3 == 0;
+        flags.PushBack(value);
+        bits.PushBack(value);
+    }
+    Report("Count", "Vector<bool>", elements, static_cast<double>(elements), bench::Measure(5, [&] {
+               size_t count = 0;
+               for (bool flag : flags) {
+                   count += flag;
+               }
+               bench::DoNotOptimize(count);
+               return elements;
+           }));
+    Report("Count", "BitVector", elements, static_cast<double>(elements) / 8, bench::Measure(5, [&] {
+               size_t count = bits.Count();
+               bench::DoNotOptimize(count);
+               return elements;
+           }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    Run(elements);
+}
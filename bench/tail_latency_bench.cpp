@@ -0,0 +1,81 @@
+// Распределение времени отдельных вставок: Vector и std::vector переносят все элементы
+// в момент роста, IncrementalVector — понемногу на каждой следующей вставке.
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/tail_latency_bench.cpp -o tail_latency_bench
+//     ./tail_latency_bench [число элементов] > tail_latency.jsonl
+//
+// Каждая строка вывода — JSON-объект с полями benchmark, container, elements, mean_ns,
+// p50_ns, p99_ns, p999_ns и max_ns. Время включает вызов steady_clock (десятки нс),
+// поэтому имеет смысл сравнивать хвосты, а не медиану. Строка с container "none" — тот же
+// цикл замеров без вставки: её максимум — шум планировщика и машины, ниже которого
+// максимум контейнеров не опустится.
+#include "bench_util.h"
+#include "incremental_vector.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+struct Payload {
+    uint64_t values[4];
+};
+
+// Пустой «контейнер» для строки с шумом замеров
+struct NoContainer {
+    void PushBack(const Payload& payload) {
+        bench::DoNotOptimize(payload);
+    }
+};
+
+template <typename Container>
+void Run(const char* name, size_t elements) {
+    std::vector<uint32_t> latencies(elements);
+    Container container;
+    for (size_t i = 0; i < elements; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        if constexpr (requires { container.PushBack(Payload{}); }) {
+            container.PushBack(Payload{{i, i, i, i}});
+        } else {
+            container.push_back(Payload{{i, i, i, i}});
+        }
+        const auto finish = std::chrono::steady_clock::now();
+        latencies[i] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count());
+    }
+    bench::DoNotOptimize(container);
+
+    double total = 0;
+    for (uint32_t latency : latencies) {
+        total += latency;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](double p) {
+        return static_cast<double>(latencies[std::min(elements - 1, static_cast<size_t>(p * elements))]);
+    };
+    bench::Report({
+        bench::Str("benchmark", "PushBackLatency"),
+        bench::Str("container", name),
+        bench::Num("elements", static_cast<double>(elements)),
+        bench::Num("mean_ns", total / static_cast<double>(elements)),
+        bench::Num("p50_ns", percentile(0.5)),
+        bench::Num("p99_ns", percentile(0.99)),
+        bench::Num("p999_ns", percentile(0.999)),
+        bench::Num("max_ns", static_cast<double>(latencies.back())),
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+    Run<NoContainer>("none", elements);
+    Run<Vector<Payload>>("Vector", elements);
+    Run<std::vector<Payload>>("std::vector", elements);
+    Run<IncrementalVector<Payload>>("IncrementalVector", elements);
+    Run<IncrementalVector<Payload, 16>>("IncrementalVector<16>", elements);
+}
@@ -0,0 +1,268 @@
+// Сравнение Vector и std::vector на основных операциях и разных типах элементов.
+//
+// Сборка и запуск:
+//     g++ -std=c++20 -O2 -DNDEBUG -I. bench/vector_bench.cpp -o vector_bench
+//     ./vector_bench [размер ...] > results.jsonl
+//
+// Каждая строка вывода — JSON-объект с полями benchmark, container, type, size,
+// ns_per_op, allocs_per_op и peak_rss_kb.
+#include "bench_util.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Pod64 {
+    uint64_t fields[8];
+};
+
+// Как Obj из main.cpp: копирование может бросить исключение, перемещение — нет
+struct ThrowingCopy {
+    ThrowingCopy() = default;
+    explicit ThrowingCopy(int id)
+        : id(id) {
+    }
+    ThrowingCopy(const ThrowingCopy& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+    }
+    ThrowingCopy(ThrowingCopy&& other) noexcept
+        : id(other.id) {
+    }
+    ThrowingCopy& operator=(const ThrowingCopy& other) = default;
+    ThrowingCopy& operator=(ThrowingCopy&& other) = default;
+
+    bool throw_on_copy = false;
+    int id = 0;
+};
+
+template <typename T>
+T MakeValue(size_t i);
+
+template <>
+int MakeValue<int>(size_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+Pod64 MakeValue<Pod64>(size_t i) {
+    Pod64 value{};
+    value.fields[0] = i;
+    return value;
+}
+
+template <>
+std::string MakeValue<std::string>(size_t i) {
+    // Длиннее буфера малой строки, чтобы копирование выделяло память
+    return "element number " + std::to_string(i) + " with a heap-allocated payload";
+}
+
+template <>
+ThrowingCopy MakeValue<ThrowingCopy>(size_t i) {
+    return ThrowingCopy(static_cast<int>(i));
+}
+
+template <typename T>
+uint64_t Checksum(const T& value) {
+    if constexpr (std::is_same_v<T, int>) {
+        return static_cast<uint64_t>(value);
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        return value.fields[0];
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    } else {
+        return static_cast<uint64_t>(value.id);
+    }
+}
+
+// Единый интерфейс к обоим контейнерам
+template <typename T>
+struct VectorOps {
+    using Container = Vector<T>;
+    static constexpr const char* kName = "Vector";
+
+    static void Reserve(Container& c, size_t n) {
+        c.Reserve(n);
+    }
+    static void PushBack(Container& c, const T& value) {
+        c.PushBack(value);
+    }
+    static void EmplaceBack(Container& c, T&& value) {
+        c.EmplaceBack(std::move(value));
+    }
+    static void EmplaceMiddle(Container& c, T&& value) {
+        c.Emplace(c.begin() + c.Size() / 2, std::move(value));
+    }
+    static void EraseMiddle(Container& c) {
+        c.Erase(c.begin() + c.Size() / 2);
+    }
+    static void Resize(Container& c, size_t n) {
+        c.Resize(n);
+    }
+};
+
+template <typename T>
+struct StdVectorOps {
+    using Container = std::vector<T>;
+    static constexpr const char* kName = "std::vector";
+
+    static void Reserve(Container& c, size_t n) {
+        c.reserve(n);
+    }
+    static void PushBack(Container& c, const T& value) {
+        c.push_back(value);
+    }
+    static void EmplaceBack(Container& c, T&& value) {
+        c.emplace_back(std::move(value));
+    }
+    static void EmplaceMiddle(Container& c, T&& value) {
+        c.emplace(c.begin() + c.size() / 2, std::move(value));
+    }
+    static void EraseMiddle(Container& c) {
+        c.erase(c.begin() + c.size() / 2);
+    }
+    static void Resize(Container& c, size_t n) {
+        c.resize(n);
+    }
+};
+
+template <typename Ops, typename T>
+typename Ops::Container Filled(const std::vector<T>& values) {
+    typename Ops::Container c;
+    Ops::Reserve(c, values.size());
+    for (const auto& value : values) {
+        Ops::PushBack(c, value);
+    }
+    return c;
+}
+
+template <typename Ops, typename T>
+void RunSuite(const char* type_name, size_t size, int repetitions) {
+    using Container = typename Ops::Container;
+
+    std::vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(MakeValue<T>(i));
+    }
+    const std::vector<bench::Field> params{
+        bench::Str("container", Ops::kName),
+        bench::Str("type", type_name),
+        bench::Num("size", static_cast<double>(size)),
+    };
+    // Вставка и удаление в середине стоят O(n), поэтому их число ограничено
+    const size_t middle_ops = std::min<size_t>(size, 1000);
+
+    bench::Report("PushBack", params, bench::Measure(repetitions, [&] {
+        Container c;
+        for (size_t i = 0; i < size; ++i) {
+            Ops::PushBack(c, values[i]);
+        }
+        bench::DoNotOptimize(c);
+        return size;
+    }));
+
+    bench::Report("PushBackReserved", params, bench::Measure(repetitions, [&] {
+        Container c;
+        Ops::Reserve(c, size);
+        for (size_t i = 0; i < size; ++i) {
+            Ops::PushBack(c, values[i]);
+        }
+        bench::DoNotOptimize(c);
+        return size;
+    }));
+
+    bench::Report("EmplaceBack", params, bench::Measure(repetitions, [&] {
+        Container c;
+        for (size_t i = 0; i < size; ++i) {
+            Ops::EmplaceBack(c, MakeValue<T>(i));
+        }
+        bench::DoNotOptimize(c);
+        return size;
+    }));
+
+    bench::Report("EmplaceMiddle", params, bench::Measure(repetitions, [&] {
+        Container c = Filled<Ops>(values);
+        for (size_t i = 0; i < middle_ops; ++i) {
+            Ops::EmplaceMiddle(c, MakeValue<T>(i));
+        }
+        bench::DoNotOptimize(c);
+        return middle_ops;
+    }));
+
+    bench::Report("EraseMiddle", params, bench::Measure(repetitions, [&] {
+        Container c = Filled<Ops>(values);
+        for (size_t i = 0; i < middle_ops; ++i) {
+            Ops::EraseMiddle(c);
+        }
+        bench::DoNotOptimize(c);
+        return middle_ops;
+    }));
+
+    const Container source = Filled<Ops>(values);
+
+    bench::Report("CopyAssign", params, bench::Measure(repetitions, [&] {
+        Container c;
+        c = source;
+        bench::DoNotOptimize(c);
+        return size_t{1};
+    }));
+
+    bench::Report("MoveAssign", params, bench::Measure(repetitions, [&] {
+        Container from = source;
+        Container to;
+        to = std::move(from);
+        bench::DoNotOptimize(to);
+        return size_t{1};
+    }));
+
+    bench::Report("Resize", params, bench::Measure(repetitions, [&] {
+        Container c;
+        Ops::Resize(c, size);
+        Ops::Resize(c, size / 2);
+        Ops::Resize(c, size);
+        bench::DoNotOptimize(c);
+        return size;
+    }));
+
+    bench::Report("Iterate", params, bench::Measure(repetitions, [&] {
+        uint64_t sum = 0;
+        for (const T& value : source) {
+            sum += Checksum(value);
+        }
+        bench::DoNotOptimize(sum);
+        return size;
+    }));
+}
+
+template <typename T>
+void RunBoth(const char* type_name, size_t size, int repetitions) {
+    RunSuite<VectorOps<T>, T>(type_name, size, repetitions);
+    RunSuite<StdVectorOps<T>, T>(type_name, size, repetitions);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {1'000, 100'000, 1'000'000};
+    }
+
+    const int repetitions = 5;
+    for (size_t size : sizes) {
+        RunBoth<int>("int", size, repetitions);
+        RunBoth<Pod64>("Pod64", size, repetitions);
+        RunBoth<std::string>("std::string", size, repetitions);
+        RunBoth<ThrowingCopy>("ThrowingCopy", size, repetitions);
+    }
+}
@@ -0,0 +1,99 @@
+// a = b * c + d над Vector<float>: ручной цикл, вычисление через временные векторы
+// (по вектору на каждую операцию) и выражение из vector_expr.h. Отдельно — тот же расчёт
+// с результатом в одном из операндов (b = b * c + d).
+//
+// Сборка и запуск (с -O2 GCC не векторизует ни ручной цикл, ни цикл выражения):
+//     g++ -std=c++20 -O3 -march=native -DNDEBUG -I. bench/vector_expr_bench.cpp -o vector_expr_bench
+//     ./vector_expr_bench [размер ...] > vector_expr.jsonl
+//
+// Каждая строка вывода — JSON-объект с полями benchmark, method, size, ns_per_op
+// (на элемент), allocs_per_op и peak_rss_kb.
+#include "bench_util.h"
+#include "vector.h"
+#include "vector_expr.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr size_t kElementsPerRun = 100'000'000;
+
+template <typename Body>
+void Run(const char* benchmark, const char* method, size_t size, Body body) {
+    const size_t rounds = std::max<size_t>(1, kElementsPerRun / size);
+    bench::Report(benchmark, {bench::Str("method", method), bench::Num("size", static_cast<double>(size))},
+                  bench::Measure(3, [&] {
+                      for (size_t round = 0; round < rounds; ++round) {
+                          body();
+                      }
+                      return rounds * size;
+                  }));
+}
+
+Vector<float> Multiply(const Vector<float>& lhs, const Vector<float>& rhs) {
+    Vector<float> result(lhs.Size(), kDefaultInit);
+    for (size_t i = 0; i < lhs.Size(); ++i) {
+        result[i] = lhs[i] * rhs[i];
+    }
+    return result;
+}
+
+Vector<float> Add(const Vector<float>& lhs, const Vector<float>& rhs) {
+    Vector<float> result(lhs.Size(), kDefaultInit);
+    for (size_t i = 0; i < lhs.Size(); ++i) {
+        result[i] = lhs[i] + rhs[i];
+    }
+    return result;
+}
+
+void RunSize(size_t size) {
+    Vector<float> a(size);
+    Vector<float> b(size);
+    Vector<float> c(size);
+    Vector<float> d(size);
+    for (size_t i = 0; i < size; ++i) {
+        b[i] = static_cast<float>(i % 17) * 0.25f;
+        c[i] = 0.999f;
+        d[i] = static_cast<float>(i % 5);
+    }
+
+    Run("MulAdd", "HandLoop", size, [&] {
+        float* out = a.begin();
+        const float* x = b.begin();
+        const float* y = c.begin();
+        const float* z = d.begin();
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = x[i] * y[i] + z[i];
+        }
+        bench::DoNotOptimize(a);
+    });
+    Run("MulAdd", "Temporaries", size, [&] {
+        a = Add(Multiply(b, c), d);
+        bench::DoNotOptimize(a);
+    });
+    Run("MulAdd", "Expression", size, [&] {
+        a = b * c + d;
+        bench::DoNotOptimize(a);
+    });
+    // Значения b сходятся к d + 1 и не уходят ни в бесконечность, ни в денормалы
+    Run("MulAddInPlace", "Expression", size, [&] {
+        b = b * c + (d + 1.0f) * 0.001f;
+        bench::DoNotOptimize(b);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {1'000, 100'000, 10'000'000};
+    }
+    for (size_t size : sizes) {
+        RunSize(size);
+    }
+}
@@ -0,0 +1,276 @@
+#pragma once
+#include "allocators.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace buffer_cache_detail {
+struct ThreadCache;
+}  // namespace buffer_cache_detail
+
+// Счётчики кеша одного потока
+struct BufferCacheStats {
+    // Выделения, обслуженные из кеша
+    size_t hits = 0;
+    // Выделения, ушедшие в operator new
+    size_t misses = 0;
+    // Освобождённые блоки, оставленные в кеше
+    size_t recycled = 0;
+    // Освобождённые блоки, отданные operator delete: корзина полна или блок слишком велик
+    size_t released = 0;
+    // Сколько байт сейчас лежит в кеше
+    size_t cached_bytes = 0;
+
+    double HitRate() const noexcept {
+        const size_t total = hits + misses;
+        return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+// Кеш освобождённых буферов своего потока. Блоки разложены по корзинам размеров-степеней
+// двойки от 16 байт до 1 МиБ; освобождённый блок кладётся в односвязный список своей
+// корзины (указатель хранится в самом блоке), и следующее выделение того же класса
+// забирает его без обращения к malloc и без синхронизации. Более крупные блоки кеш
+// не хранит.
+//
+// Корзина держит не больше BucketLimit блоков, по умолчанию — на kDefaultBucketBytes байт,
+// но не меньше kMinBucketLimit блоков; лишние освобождаются сразу. Trim(max_bytes) отдаёт
+// закешированное, начиная с крупных блоков. При завершении потока кеш освобождается целиком.
+//
+// Блок, освобождённый в другом потоке, попадает в кеш этого потока: память переезжает
+// между потоками, но не теряется
+class BufferCache {
+public:
+    static constexpr size_t kMinBlockShift = 4;
+    static constexpr size_t kMaxBlockShift = 20;
+    static constexpr size_t kMinBlockBytes = size_t{1} << kMinBlockShift;
+    static constexpr size_t kMaxBlockBytes = size_t{1} << kMaxBlockShift;
+    static constexpr size_t kBuckets = kMaxBlockShift - kMinBlockShift + 1;
+    static constexpr size_t kDefaultBucketBytes = 64 * 1024;
+    static constexpr size_t kMinBucketLimit = 4;
+
+    BufferCache() noexcept {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            buckets_[i].limit = std::max(kMinBucketLimit, kDefaultBucketBytes / BucketBlockSize(i));
+        }
+    }
+
+    BufferCache(const BufferCache&) = delete;
+    BufferCache& operator=(const BufferCache&) = delete;
+
+    ~BufferCache() {
+        Trim();
+    }
+
+    // Кеш текущего потока
+    static BufferCache& Local() noexcept;
+
+    // Размер блока, которым обслуживается запрос bytes байт: степень двойки для
+    // кешируемых размеров, иначе сам запрос
+    static size_t BlockSize(size_t bytes) noexcept {
+        return bytes > kMaxBlockBytes ? bytes : std::bit_ceil(std::max(bytes, kMinBlockBytes));
+    }
+
+    // Выделяет BlockSize(bytes) байт через кеш текущего потока. Вызовы из деструкторов
+    // thread_local и статических объектов, которые выполняются после уничтожения кеша
+    // потока, идут прямо в operator new/delete
+    static void* Acquire(size_t bytes) {
+        return thread_cache_destroyed_ ? ::operator new(BlockSize(bytes)) : Local().Allocate(bytes);
+    }
+
+    static void Recycle(void* p, size_t bytes) noexcept {
+        if (thread_cache_destroyed_) {
+            ::operator delete(p);
+        } else {
+            Local().Deallocate(p, bytes);
+        }
+    }
+
+    void* Allocate(size_t bytes) {
+        const size_t block = BlockSize(bytes);
+        if (block <= kMaxBlockBytes) {
+            Bucket& bucket = buckets_[BucketIndex(block)];
+            if (bucket.head != nullptr) {
+                FreeBlock* head = bucket.head;
+                bucket.head = head->next;
+                --bucket.count;
+                stats_.cached_bytes -= block;
+                ++stats_.hits;
+                return head;
+            }
+        }
+        ++stats_.misses;
+        return ::operator new(block);
+    }
+
+    // bytes — тот же размер, что при выделении (или любой с тем же BlockSize)
+    void Deallocate(void* p, size_t bytes) noexcept {
+        const size_t block = BlockSize(bytes);
+        if (block <= kMaxBlockBytes) {
+            Bucket& bucket = buckets_[BucketIndex(block)];
+            if (bucket.count < bucket.limit) {
+                bucket.head = new (p) FreeBlock{bucket.head};
+                ++bucket.count;
+                stats_.cached_bytes += block;
+                ++stats_.recycled;
+                return;
+            }
+        }
+        ++stats_.released;
+        ::operator delete(p);
+    }
+
+    size_t BucketLimit(size_t block_bytes) const noexcept {
+        assert(BlockSize(block_bytes) <= kMaxBlockBytes);
+        return buckets_[BucketIndex(BlockSize(block_bytes))].limit;
+    }
+
+    // Ограничивает число блоков в корзине блоков размера BlockSize(block_bytes);
+    // лишние закешированные блоки освобождаются сразу. Лимит 0 выключает кеш для класса
+    void SetBucketLimit(size_t block_bytes, size_t limit) noexcept {
+        assert(BlockSize(block_bytes) <= kMaxBlockBytes);
+        const size_t index = BucketIndex(BlockSize(block_bytes));
+        buckets_[index].limit = limit;
+        TrimBucket(index, limit);
+    }
+
+    void SetBucketLimits(size_t limit) noexcept {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            buckets_[i].limit = limit;
+            TrimBucket(i, limit);
+        }
+    }
+
+    // Освобождает закешированные блоки, пока в кеше больше max_bytes байт, начиная с крупных
+    void Trim(size_t max_bytes = 0) noexcept {
+        for (size_t i = kBuckets; i-- > 0 && stats_.cached_bytes > max_bytes;) {
+            const size_t excess = (stats_.cached_bytes - max_bytes + BucketBlockSize(i) - 1) / BucketBlockSize(i);
+            const size_t count = buckets_[i].count;
+            TrimBucket(i, count > excess ? count - excess : 0);
+        }
+    }
+
+    const BufferCacheStats& Stats() const noexcept {
+        return stats_;
+    }
+
+    // Обнуляет счётчики событий; cached_bytes остаётся
+    void ResetStats() noexcept {
+        stats_ = BufferCacheStats{.cached_bytes = stats_.cached_bytes};
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Bucket {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+        size_t limit = 0;
+    };
+
+    static size_t BucketIndex(size_t block) noexcept {
+        return static_cast<size_t>(std::countr_zero(block)) - kMinBlockShift;
+    }
+
+    static size_t BucketBlockSize(size_t index) noexcept {
+        return size_t{1} << (index + kMinBlockShift);
+    }
+
+    void TrimBucket(size_t index, size_t keep) noexcept {
+        Bucket& bucket = buckets_[index];
+        while (bucket.count > keep) {
+            FreeBlock* head = bucket.head;
+            bucket.head = head->next;
+            --bucket.count;
+            stats_.cached_bytes -= BucketBlockSize(index);
+            ::operator delete(head);
+        }
+    }
+
+    friend struct buffer_cache_detail::ThreadCache;
+
+    std::array<Bucket, kBuckets> buckets_;
+    BufferCacheStats stats_;
+
+    // Флаг тривиального типа, поэтому остаётся доступным и после уничтожения кеша потока
+    static inline thread_local bool thread_cache_destroyed_ = false;
+};
+
+namespace buffer_cache_detail {
+
+struct ThreadCache : BufferCache {
+    ~ThreadCache() {
+        thread_cache_destroyed_ = true;
+    }
+};
+
+inline thread_local ThreadCache g_thread_cache;
+
+}  // namespace buffer_cache_detail
+
+inline BufferCache& BufferCache::Local() noexcept {
+    return buffer_cache_detail::g_thread_cache;
+}
+
+// Аллокатор поверх BufferCache: короткоживущие векторы берут буферы из кеша своего потока.
+// Вместимость округляется до размера блока (степени двойки), поэтому при росте удвоением
+// каждая ступень попадает в свою корзину, а освобождённый буфер подходит следующему
+// вектору того же размера:
+//
+//     Vector<Hit, CachingAllocator<Hit>> hits;  // вместо Vector<Hit> на горячем пути
+template <typename T>
+class CachingAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "operator new cannot satisfy alignment of T");
+
+    CachingAllocator() = default;
+
+    template <typename U>
+    CachingAllocator(const CachingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const size_t bytes = BytesFor(n);
+        T* p = static_cast<T*>(BufferCache::Acquire(bytes));
+        return {p, BufferCache::BlockSize(bytes) / sizeof(T)};
+    }
+
+    // Вместимость из allocate_at_least занимает больше половины блока, поэтому n * sizeof(T)
+    // снова даёт тот же класс размера
+    void deallocate(T* p, size_t n) noexcept {
+        BufferCache::Recycle(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const CachingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CachingAllocator<U>&) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t BytesFor(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+};
@@ -0,0 +1,264 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+// Вектор только для добавления, в который могут одновременно писать несколько потоков.
+// Элементы хранятся в сегментах RawMemory, каждый следующий вдвое больше предыдущего:
+// сегменты никогда не переезжают, поэтому ссылки, указатели и итераторы на элементы
+// остаются действительными всё время жизни вектора.
+//
+// EmplaceBack неблокирующий: индекс нового элемента занимается атомарным счётчиком,
+// новый сегмент выделяет первый дошедший до него поток. Элемент становится опубликованным,
+// когда он и все элементы перед ним созданы; Size() — число опубликованных элементов,
+// и operator[] для них работает без ожидания.
+//
+// Элемент создаётся до того, как ему выделяется индекс, и затем переносится на место,
+// поэтому исключение конструктора не оставляет в векторе дыр. Перенос не должен бросать.
+// Reserve можно вызывать одновременно с EmplaceBack; деструктор — только после того,
+// как остальные потоки закончили работу с вектором.
+template <typename T, size_t FirstSegment = 64>
+class ConcurrentVector {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "ConcurrentVector requires a nothrow move constructor");
+    static_assert(std::has_single_bit(FirstSegment), "FirstSegment must be a power of two");
+
+    static constexpr size_t kFirstShift = std::bit_width(FirstSegment) - 1;
+    static constexpr size_t kMaxSegments = 8 * sizeof(size_t) - kFirstShift;
+
+    struct Segment {
+        explicit Segment(size_t size)
+            : elements(size)
+            , ready(std::make_unique<std::atomic<bool>[]>(size)) {
+        }
+
+        RawMemory<T> elements;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+public:
+    template <bool IsConst>
+    class Iterator {
+        using Owner = std::conditional_t<IsConst, const ConcurrentVector, ConcurrentVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+
+        Iterator() = default;
+        Iterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            return Iterator(owner_, index_++);
+        }
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        Iterator operator--(int) noexcept {
+            return Iterator(owner_, index_--);
+        }
+        Iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        Iterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+        Iterator operator+(difference_type offset) const noexcept {
+            return Iterator(owner_, index_ + offset);
+        }
+        friend Iterator operator+(difference_type offset, const Iterator& it) noexcept {
+            return it + offset;
+        }
+        Iterator operator-(difference_type offset) const noexcept {
+            return Iterator(owner_, index_ - offset);
+        }
+        difference_type operator-(const Iterator& other) const noexcept {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+        bool operator!=(const Iterator& other) const noexcept {
+            return index_ != other.index_;
+        }
+        bool operator<(const Iterator& other) const noexcept {
+            return index_ < other.index_;
+        }
+        bool operator>(const Iterator& other) const noexcept {
+            return index_ > other.index_;
+        }
+        bool operator<=(const Iterator& other) const noexcept {
+            return index_ <= other.index_;
+        }
+        bool operator>=(const Iterator& other) const noexcept {
+            return index_ >= other.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    ConcurrentVector() = default;
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        const size_t size = reserved_.load(std::memory_order_acquire);
+        for (size_t k = 0; k < kMaxSegments; ++k) {
+            Segment* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            const size_t first = SegmentStart(k);
+            if (first < size) {
+                std::destroy_n(segment->elements.GetAddress(), std::min(size - first, SegmentSize(k)));
+            }
+            delete segment;
+        }
+    }
+
+    // Число опубликованных элементов
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Элемент с индексом меньше Size() или элемент, который этот поток сам добавил
+    T& operator[](size_t index) noexcept {
+        const size_t k = SegmentOf(index);
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        assert(segment != nullptr);
+        return segment->elements[index - SegmentStart(k)];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    // Итераторы охватывают элементы, опубликованные к моменту вызова end()
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, Size()};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, Size()};
+    }
+
+    // Заранее выделяет сегменты под capacity элементов, чтобы EmplaceBack не выделял память
+    void Reserve(size_t capacity) {
+        for (size_t k = 0; k < kMaxSegments && SegmentStart(k) < capacity; ++k) {
+            EnsureSegment(k);
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        T value(std::forward<Args>(args)...);
+
+        // Сегмент под индекс выделяется до того, как индекс занят: если выделение бросит,
+        // в векторе не останется незаполненного места. Захват индекса публикует сегмент
+        // (release): поток, прочитавший reserved_ с acquire, видит сегменты всех индексов ниже
+        size_t index = reserved_.load(std::memory_order_relaxed);
+        Segment* segment = nullptr;
+        do {
+            segment = EnsureSegment(SegmentOf(index));
+        } while (!reserved_.compare_exchange_weak(index, index + 1, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+
+        const size_t offset = index - SegmentStart(SegmentOf(index));
+        T* elem = new (segment->elements.GetAddress() + offset) T(std::move(value));
+        segment->ready[offset].store(true);
+        Publish();
+        return *elem;
+    }
+
+private:
+    static size_t SegmentOf(size_t index) noexcept {
+        return std::bit_width((index >> kFirstShift) + 1) - 1;
+    }
+
+    static size_t SegmentStart(size_t k) noexcept {
+        return ((size_t{1} << k) - 1) << kFirstShift;
+    }
+
+    static size_t SegmentSize(size_t k) noexcept {
+        return FirstSegment << k;
+    }
+
+    Segment* EnsureSegment(size_t k) {
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        if (segment != nullptr) {
+            return segment;
+        }
+        auto created = std::make_unique<Segment>(SegmentSize(k));
+        if (segments_[k].compare_exchange_strong(segment, created.get(), std::memory_order_acq_rel)) {
+            return created.release();
+        }
+        // Сегмент уже выделил другой поток
+        return segment;
+    }
+
+    // index должен быть меньше значения reserved_, прочитанного с acquire
+    bool IsReady(size_t index) const noexcept {
+        const size_t k = SegmentOf(index);
+        return segments_[k].load(std::memory_order_acquire)->ready[index - SegmentStart(k)].load();
+    }
+
+    // Продвигает Size() через все созданные подряд элементы. Поток, создавший элемент
+    // последним, всегда доводит счётчик до него, поэтому ожидать других потоков не нужно
+    void Publish() noexcept {
+        size_t size = size_.load();
+        while (size < reserved_.load(std::memory_order_acquire) && IsReady(size)) {
+            if (size_.compare_exchange_weak(size, size + 1)) {
+                ++size;
+            }
+        }
+    }
+
+    std::atomic<Segment*> segments_[kMaxSegments] = {};
+    std::atomic<size_t> reserved_{0};
+    std::atomic<size_t> size_{0};
+};
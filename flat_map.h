@@ -0,0 +1,527 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+// Как искать ключ в FlatSet/FlatMap. kSorted — lower_bound без ветвлений по отсортированному
+// массиву. kEytzinger — дополнительно хранит ключи в порядке обхода дерева в ширину
+// (a[k] с потомками a[2k], a[2k + 1]): первые уровни дерева лежат рядом и остаются в кеше,
+// а потомки на несколько уровней вперёд подгружаются prefetch'ем. Выигрывает на таблицах,
+// которые не помещаются в кеш, и стоит ещё одной копии ключей и массива рангов
+enum class SearchLayout {
+    kSorted,
+    kEytzinger,
+};
+
+namespace flat_detail {
+
+// lower_bound, в котором выбор половины — условное присваивание, а не переход:
+// цикл выполняет ровно log2(n) итераций, и процессору нечего предсказывать
+template <typename K, typename Compare>
+size_t BranchlessLowerBound(const K* data, size_t n, const K& key, const Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const K* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = comp(base[half], key) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<size_t>(base - data) + comp(*base, key);
+}
+
+template <typename K, typename Compare>
+class EytzingerIndex {
+    // Потомки узла k на глубине d занимают [k * 2^d, (k + 1) * 2^d): при kStride ключах
+    // в кеш-линии одна подкачка покрывает целый уровень поддерева
+    static constexpr size_t kStride = kCacheLineSize / sizeof(K);
+
+public:
+    void Build(const K* sorted, size_t n) {
+        Vector<K> keys(n + 1);
+        Vector<size_t> ranks(n + 1);
+        size_t next = 0;
+        Fill(sorted, n, keys, ranks, 1, next);
+        keys_.Swap(keys);
+        ranks_.Swap(ranks);
+    }
+
+    void Clear() noexcept {
+        Vector<K>().Swap(keys_);
+        Vector<size_t>().Swap(ranks_);
+    }
+
+    // Ранг (позиция в отсортированном массиве) первого ключа, не меньшего key, или n
+    size_t LowerBound(const K& key, const Compare& comp) const {
+        const size_t k = Descend(key, comp);
+        return k == 0 ? Count() : ranks_[k];
+    }
+
+    // Ранг ключа key или n, если его нет. Сравнение идёт с узлом, пройденным при спуске
+    // и уже лежащим в кеше, а не с отсортированным массивом
+    size_t Find(const K& key, const Compare& comp) const {
+        const size_t k = Descend(key, comp);
+        return k == 0 || comp(key, keys_[k]) ? Count() : ranks_[k];
+    }
+
+private:
+    size_t Count() const noexcept {
+        return keys_.Size() == 0 ? 0 : keys_.Size() - 1;
+    }
+
+    // Номер узла с первым ключом, не меньшим key, или 0
+    size_t Descend(const K& key, const Compare& comp) const {
+        const size_t n = Count();
+        const K* keys = keys_.begin();
+        size_t k = 1;
+        while (k <= n) {
+            if constexpr (kStride > 1) {
+                // Адрес считается в целых числах: он может выходить за массив, а prefetch не падает
+                __builtin_prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(keys)
+                                                                 + k * kStride * sizeof(K)));
+            }
+            k = 2 * k + comp(keys[k], key);
+        }
+        // Снимаем хвост переходов вправо и последний переход влево: остаётся искомый узел
+        return k >> (std::countr_one(k) + 1);
+    }
+
+    static void Fill(const K* sorted, size_t n, Vector<K>& keys, Vector<size_t>& ranks, size_t k, size_t& next) {
+        if (k > n) {
+            return;
+        }
+        Fill(sorted, n, keys, ranks, 2 * k, next);
+        keys[k] = sorted[next];
+        ranks[k] = next++;
+        Fill(sorted, n, keys, ranks, 2 * k + 1, next);
+    }
+
+    Vector<K> keys_;
+    Vector<size_t> ranks_;
+};
+
+// Общая часть FlatSet и FlatMap: отсортированные уникальные ключи и поиск по ним
+template <typename K, typename Compare>
+class SortedKeys {
+public:
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool IsEmpty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    std::span<const K> Keys() const noexcept {
+        return {keys_.begin(), keys_.Size()};
+    }
+
+    SearchLayout GetSearchLayout() const noexcept {
+        return layout_;
+    }
+
+    // kEytzinger строит индекс сразу и перестраивает его после каждого изменения. Если
+    // перестройка бросит исключение, изменение выполнено, а раскладка возвращается к kSorted
+    void SetSearchLayout(SearchLayout layout) {
+        if (layout == SearchLayout::kEytzinger) {
+            index_.Build(keys_.begin(), keys_.Size());
+        } else {
+            index_.Clear();
+        }
+        layout_ = layout;
+    }
+
+    // Позиция первого ключа, не меньшего key, или Size()
+    size_t LowerBound(const K& key) const {
+        if (layout_ == SearchLayout::kEytzinger) {
+            return index_.LowerBound(key, comp_);
+        }
+        return BranchlessLowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    bool Contains(const K& key) const {
+        return IndexOf(key) != keys_.Size();
+    }
+
+protected:
+    explicit SortedKeys(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    // Позиция ключа key или Size(), если его нет
+    size_t IndexOf(const K& key) const {
+        if (layout_ == SearchLayout::kEytzinger) {
+            return index_.Find(key, comp_);
+        }
+        const size_t index = LowerBound(key);
+        return index != keys_.Size() && !comp_(key, keys_[index]) ? index : keys_.Size();
+    }
+
+    bool Equivalent(const K& lhs, const K& rhs) const {
+        return !comp_(lhs, rhs) && !comp_(rhs, lhs);
+    }
+
+    // Сортирует пакет ключей и удаляет повторы
+    void SortUnique(Vector<K>& keys) const {
+        std::sort(keys.begin(), keys.end(), comp_);
+        keys.Erase(std::unique(keys.begin(), keys.end(),
+                               [this](const K& lhs, const K& rhs) {
+                                   return Equivalent(lhs, rhs);
+                               }),
+                   keys.end());
+    }
+
+    // Вызывается после изменения keys_. Если перестроить индекс не удалось, старый индекс
+    // не годится для новых ключей: поиск переходит на kSorted, изменение ключей остаётся,
+    // а исключение пробрасывается
+    void Reindex() {
+        if (layout_ == SearchLayout::kEytzinger) {
+            try {
+                index_.Build(keys_.begin(), keys_.Size());
+            } catch (...) {
+                index_.Clear();
+                layout_ = SearchLayout::kSorted;
+                throw;
+            }
+        }
+    }
+
+    Vector<K> keys_;
+    [[no_unique_address]] Compare comp_;
+    SearchLayout layout_ = SearchLayout::kSorted;
+    EytzingerIndex<K, Compare> index_;
+};
+
+}  // namespace flat_detail
+
+// Множество на отсортированном Vector: поиск идёт по непрерывному массиву ключей без
+// переходов по указателям. Рассчитано на таблицы, которые читают намного чаще, чем меняют:
+//
+//     FlatSet<uint64_t> ids(std::move(raw_ids));  // сортировка и удаление повторов один раз
+//     ids.SetSearchLayout(SearchLayout::kEytzinger);
+//     if (ids.Contains(id)) { ... }
+//
+// Одиночные Insert/Erase сдвигают хвост (O(n)); пакетные Insert(first, last) и
+// EraseKeys(first, last) сортируют пакет и сливают его с массивом за один проход.
+// Пакетная вставка даёт строгую гарантию, если перемещение ключей не бросает исключений
+template <typename K, typename Compare = std::less<K>>
+class FlatSet : public flat_detail::SortedKeys<K, Compare> {
+    using Base = flat_detail::SortedKeys<K, Compare>;
+    using Base::comp_;
+    using Base::keys_;
+
+public:
+    using const_iterator = const K*;
+    using iterator = const_iterator;
+
+    explicit FlatSet(const Compare& comp = Compare())
+        : Base(comp) {
+    }
+
+    explicit FlatSet(Vector<K> keys, const Compare& comp = Compare())
+        : Base(comp) {
+        Base::SortUnique(keys);
+        keys_.Swap(keys);
+    }
+
+    FlatSet(std::initializer_list<K> init, const Compare& comp = Compare())
+        : FlatSet(Vector<K>(init), comp) {
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    const_iterator Find(const K& key) const {
+        return keys_.begin() + Base::IndexOf(key);
+    }
+
+    // Возвращает false, если ключ уже есть
+    bool Insert(const K& key) {
+        const size_t index = Base::LowerBound(key);
+        if (index != keys_.Size() && !comp_(key, keys_[index])) {
+            return false;
+        }
+        keys_.Insert(keys_.begin() + index, key);
+        Base::Reindex();
+        return true;
+    }
+
+    // Возвращает число добавленных ключей
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t Insert(InputIt first, InputIt last) {
+        Vector<K> batch(first, last);
+        Base::SortUnique(batch);
+        if (batch.Size() == 0) {
+            return 0;
+        }
+
+        Vector<K> merged;
+        merged.Reserve(keys_.Size() + batch.Size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < keys_.Size() && j < batch.Size()) {
+            if (comp_(keys_[i], batch[j])) {
+                merged.PushBack(std::move_if_noexcept(keys_[i++]));
+            } else if (comp_(batch[j], keys_[i])) {
+                merged.PushBack(std::move(batch[j++]));
+            } else {
+                merged.PushBack(std::move_if_noexcept(keys_[i++]));
+                ++j;
+            }
+        }
+        for (; i < keys_.Size(); ++i) {
+            merged.PushBack(std::move_if_noexcept(keys_[i]));
+        }
+        for (; j < batch.Size(); ++j) {
+            merged.PushBack(std::move(batch[j]));
+        }
+
+        const size_t inserted = merged.Size() - keys_.Size();
+        keys_.Swap(merged);
+        Base::Reindex();
+        return inserted;
+    }
+
+    void Insert(std::initializer_list<K> init) {
+        Insert(init.begin(), init.end());
+    }
+
+    bool Erase(const K& key) {
+        const size_t index = Base::IndexOf(key);
+        if (index == keys_.Size()) {
+            return false;
+        }
+        keys_.Erase(keys_.begin() + index);
+        Base::Reindex();
+        return true;
+    }
+
+    // Удаляет все ключи из [first, last) за один проход; возвращает число удалённых
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t EraseKeys(InputIt first, InputIt last) {
+        Vector<K> batch(first, last);
+        Base::SortUnique(batch);
+        size_t j = 0;
+        const size_t erased = keys_.EraseIf([&](const K& key) {
+            while (j < batch.Size() && comp_(batch[j], key)) {
+                ++j;
+            }
+            return j < batch.Size() && !comp_(key, batch[j]);
+        });
+        if (erased != 0) {
+            Base::Reindex();
+        }
+        return erased;
+    }
+};
+
+// Отображение на двух отсортированных Vector: ключи и значения хранятся раздельно, поэтому
+// поиск читает только плотный массив ключей. Поиск, раскладка и пакетные операции — как
+// у FlatSet; при совпадении ключей остаётся уже записанное значение, как в std::map::insert.
+//
+//     FlatMap<uint32_t, Route> routes(std::move(entries));  // Vector<std::pair<K, V>>
+//     if (const Route* route = routes.Find(prefix)) { ... }
+//     routes.Insert(updates.begin(), updates.end());
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap : public flat_detail::SortedKeys<K, Compare> {
+    using Base = flat_detail::SortedKeys<K, Compare>;
+    using Base::comp_;
+    using Base::keys_;
+
+public:
+    using Entry = std::pair<K, V>;
+
+    explicit FlatMap(const Compare& comp = Compare())
+        : Base(comp) {
+    }
+
+    explicit FlatMap(Vector<Entry> entries, const Compare& comp = Compare())
+        : Base(comp) {
+        SortUnique(entries);
+        Vector<K> keys;
+        Vector<V> values;
+        Split(entries, keys, values);
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+
+    FlatMap(std::initializer_list<Entry> init, const Compare& comp = Compare())
+        : FlatMap(Vector<Entry>(init), comp) {
+    }
+
+    std::span<V> Values() noexcept {
+        return {values_.begin(), values_.Size()};
+    }
+
+    std::span<const V> Values() const noexcept {
+        return {values_.begin(), values_.Size()};
+    }
+
+    // nullptr, если ключа нет
+    V* Find(const K& key) {
+        const size_t index = Base::IndexOf(key);
+        return index == keys_.Size() ? nullptr : &values_[index];
+    }
+
+    const V* Find(const K& key) const {
+        return const_cast<FlatMap&>(*this).Find(key);
+    }
+
+    V& At(const K& key) {
+        V* value = Find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("FlatMap::At: no such key");
+        }
+        return *value;
+    }
+
+    const V& At(const K& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    // Возвращает false и не меняет значение, если ключ уже есть
+    bool Insert(const K& key, const V& value) {
+        const size_t index = Base::LowerBound(key);
+        if (index != keys_.Size() && !comp_(key, keys_[index])) {
+            return false;
+        }
+        keys_.Insert(keys_.begin() + index, key);
+        try {
+            values_.Insert(values_.begin() + index, value);
+        } catch (...) {
+            keys_.Erase(keys_.begin() + index);
+            throw;
+        }
+        Base::Reindex();
+        return true;
+    }
+
+    // Пакетная вставка пар; возвращает число добавленных ключей
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t Insert(InputIt first, InputIt last) {
+        Vector<Entry> batch(first, last);
+        SortUnique(batch);
+        if (batch.Size() == 0) {
+            return 0;
+        }
+
+        Vector<K> keys;
+        Vector<V> values;
+        keys.Reserve(keys_.Size() + batch.Size());
+        values.Reserve(keys_.Size() + batch.Size());
+        const auto take_own = [&](size_t i) {
+            keys.PushBack(std::move_if_noexcept(keys_[i]));
+            values.PushBack(std::move_if_noexcept(values_[i]));
+        };
+        const auto take_batch = [&](size_t j) {
+            keys.PushBack(std::move(batch[j].first));
+            values.PushBack(std::move(batch[j].second));
+        };
+        size_t i = 0;
+        size_t j = 0;
+        while (i < keys_.Size() && j < batch.Size()) {
+            if (comp_(keys_[i], batch[j].first)) {
+                take_own(i++);
+            } else if (comp_(batch[j].first, keys_[i])) {
+                take_batch(j++);
+            } else {
+                take_own(i++);
+                ++j;
+            }
+        }
+        for (; i < keys_.Size(); ++i) {
+            take_own(i);
+        }
+        for (; j < batch.Size(); ++j) {
+            take_batch(j);
+        }
+
+        const size_t inserted = keys.Size() - keys_.Size();
+        keys_.Swap(keys);
+        values_.Swap(values);
+        Base::Reindex();
+        return inserted;
+    }
+
+    void Insert(std::initializer_list<Entry> init) {
+        Insert(init.begin(), init.end());
+    }
+
+    bool Erase(const K& key) {
+        const size_t index = Base::IndexOf(key);
+        if (index == keys_.Size()) {
+            return false;
+        }
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+        Base::Reindex();
+        return true;
+    }
+
+    // Удаляет все ключи из [first, last) за один проход; возвращает число удалённых
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t EraseKeys(InputIt first, InputIt last) {
+        Vector<K> batch(first, last);
+        Base::SortUnique(batch);
+        size_t kept = 0;
+        size_t j = 0;
+        for (size_t i = 0; i < keys_.Size(); ++i) {
+            while (j < batch.Size() && comp_(batch[j], keys_[i])) {
+                ++j;
+            }
+            if (j < batch.Size() && !comp_(keys_[i], batch[j])) {
+                continue;
+            }
+            if (kept != i) {
+                keys_[kept] = std::move(keys_[i]);
+                values_[kept] = std::move(values_[i]);
+            }
+            ++kept;
+        }
+        const size_t erased = keys_.Size() - kept;
+        keys_.Erase(keys_.begin() + kept, keys_.end());
+        values_.Erase(values_.begin() + kept, values_.end());
+        if (erased != 0) {
+            Base::Reindex();
+        }
+        return erased;
+    }
+
+private:
+    // Сортирует пары по ключу; из повторов остаётся первая
+    void SortUnique(Vector<Entry>& entries) const {
+        std::stable_sort(entries.begin(), entries.end(), [this](const Entry& lhs, const Entry& rhs) {
+            return comp_(lhs.first, rhs.first);
+        });
+        entries.Erase(std::unique(entries.begin(), entries.end(),
+                                  [this](const Entry& lhs, const Entry& rhs) {
+                                      return Base::Equivalent(lhs.first, rhs.first);
+                                  }),
+                      entries.end());
+    }
+
+    static void Split(Vector<Entry>& entries, Vector<K>& keys, Vector<V>& values) {
+        keys.Reserve(entries.Size());
+        values.Reserve(entries.Size());
+        for (Entry& entry : entries) {
+            keys.PushBack(std::move(entry.first));
+            values.PushBack(std::move(entry.second));
+        }
+    }
+
+    Vector<V> values_;
+};
@@ -0,0 +1,352 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Вектор с постепенным переездом при росте, по образцу инкрементального рехеширования:
+// заполнившись, он выделяет буфер вдвое больше, но не переносит в него элементы сразу,
+// а держит оба буфера и переносит не более MigrationStep элементов за каждую следующую
+// вставку. Так работа одной операции ограничена сверху, и переезд большого вектора
+// не даёт всплесков задержки.
+//
+// Во время переезда элементы [0, migrated_) уже лежат в новом буфере, [migrated_, old_size_)
+// ещё в старом, а добавленные после начала переезда — в новом; operator[] остаётся O(1).
+// Новый буфер вдвое больше, а каждая вставка переносит хотя бы один элемент, поэтому
+// к моменту, когда вектор снова заполнится, от переезда остаётся не больше одного шага.
+//
+// Старый буфер возвращается системе по частям: как только перенесено kReleaseBatchBytes
+// байт целых страниц, они отдаются через madvise(MADV_DONTNEED). Поэтому освобождение
+// буфера на последнем шаге не снимает с отображения миллионы заполненных страниц разом,
+// и его стоимость тоже не зависит от размера вектора.
+//
+// Ссылки на элементы становятся недействительными при переносе этих элементов, то есть
+// во время любой вставки, пока IsMigrating(). Перенос перемещает элементы, если это
+// не бросает исключений, иначе копирует; исключение оставляет вектор корректным.
+template <typename T, size_t MigrationStep = 4>
+class IncrementalVector {
+    static_assert(MigrationStep > 0, "MigrationStep must be positive");
+
+public:
+    template <bool IsConst>
+    class Iterator {
+        using Owner = std::conditional_t<IsConst, const IncrementalVector, IncrementalVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+
+        Iterator() = default;
+        Iterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            return Iterator(owner_, index_++);
+        }
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        Iterator operator--(int) noexcept {
+            return Iterator(owner_, index_--);
+        }
+        Iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        Iterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+        Iterator operator+(difference_type offset) const noexcept {
+            return Iterator(owner_, index_ + offset);
+        }
+        friend Iterator operator+(difference_type offset, const Iterator& it) noexcept {
+            return it + offset;
+        }
+        Iterator operator-(difference_type offset) const noexcept {
+            return Iterator(owner_, index_ - offset);
+        }
+        difference_type operator-(const Iterator& other) const noexcept {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+        bool operator!=(const Iterator& other) const noexcept {
+            return index_ != other.index_;
+        }
+        bool operator<(const Iterator& other) const noexcept {
+            return index_ < other.index_;
+        }
+        bool operator>(const Iterator& other) const noexcept {
+            return index_ > other.index_;
+        }
+        bool operator<=(const Iterator& other) const noexcept {
+            return index_ <= other.index_;
+        }
+        bool operator>=(const Iterator& other) const noexcept {
+            return index_ >= other.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    IncrementalVector() = default;
+    IncrementalVector(const IncrementalVector&) = delete;
+    IncrementalVector& operator=(const IncrementalVector&) = delete;
+
+    IncrementalVector(IncrementalVector&& other) noexcept {
+        Swap(other);
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+        if (this != &rhs) {
+            IncrementalVector temp(std::move(rhs));
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        std::destroy_n(data_.GetAddress(), migrated_);
+        std::destroy(old_.GetAddress() + migrated_, old_.GetAddress() + old_size_);
+        std::destroy(data_.GetAddress() + old_size_, data_.GetAddress() + size_);
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(released_, other.released_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    bool IsMigrating() const noexcept {
+        return migrated_ != old_size_;
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index >= migrated_ && index < old_size_ ? old_[index] : data_[index];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+
+    // Явный Reserve переносит все элементы сразу: он вызывается вне критичного по задержке пути
+    void Reserve(size_t capacity) {
+        if (capacity <= Capacity()) {
+            return;
+        }
+        FinishMigration();
+        RawMemory<T> new_data(capacity);
+        if constexpr (kIsTriviallyRelocatable<T> || std::is_nothrow_move_constructible_v<T>) {
+            MigrateRange(data_.GetAddress(), new_data.GetAddress(), 0, size_);
+        } else {
+            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+        }
+        data_.Swap(new_data);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Аргументы могут ссылаться на элемент старого буфера, который шаг переезда перенесёт
+    // или вместе с буфером освободит, поэтому новый элемент создаётся до шага переезда и
+    // до смены буферов. Исключение при переносе отменяет вставку
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            return GrowAndEmplace(std::forward<Args>(args)...);
+        }
+        T* elem = new (data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+        if (IsMigrating()) {
+            try {
+                MigrateStep();
+            } catch (...) {
+                std::destroy_at(elem);
+                throw;
+            }
+        }
+        ++size_;
+        return *elem;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        std::destroy_at(&(*this)[size_ - 1]);
+        --size_;
+        if (size_ < old_size_) {
+            old_size_ = size_;
+            if (migrated_ > old_size_) {
+                migrated_ = old_size_;
+            }
+            // Удалены все ещё не перенесённые элементы: переезд закончен
+            if (!IsMigrating()) {
+                FreeOld();
+            }
+        }
+    }
+
+private:
+    template <typename... Args>
+    T& GrowAndEmplace(Args&&... args) {
+        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+        T* elem = new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+        // При шаге 1 или совсем маленьком буфере вектор может заполниться раньше, чем
+        // закончится переезд: остаток не больше одного шага и переносится здесь же
+        if (IsMigrating()) {
+            try {
+                FinishMigration();
+            } catch (...) {
+                std::destroy_at(elem);
+                throw;
+            }
+        }
+        old_.Swap(data_);
+        data_.Swap(new_data);
+        old_size_ = size_;
+        migrated_ = 0;
+        ++size_;
+        return *elem;
+    }
+
+    // Переносит элементы [first, last) из from в неинициализированную память to
+    static void MigrateRange(T* from, T* to, size_t first, size_t last) {
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            if (last != first) {
+                std::memcpy(static_cast<void*>(to + first), static_cast<const void*>(from + first),
+                            (last - first) * sizeof(T));
+            }
+        } else {
+            for (size_t i = first; i < last; ++i) {
+                new (to + i) T(std::move_if_noexcept(from[i]));
+                std::destroy_at(from + i);
+            }
+        }
+    }
+
+    void MigrateStep() {
+        const size_t last = std::min(old_size_, migrated_ + MigrationStep);
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            MigrateRange(old_.GetAddress(), data_.GetAddress(), migrated_, last);
+            migrated_ = last;
+        } else {
+            // Счётчик продвигается поэлементно, чтобы исключение при копировании не потеряло элементы
+            for (; migrated_ < last; ++migrated_) {
+                MigrateRange(old_.GetAddress(), data_.GetAddress(), migrated_, migrated_ + 1);
+            }
+        }
+        if (IsMigrating()) {
+            ReleaseMigratedPages();
+        } else {
+            FreeOld();
+        }
+    }
+
+    // Возвращает системе целые страницы старого буфера, элементы которых уже перенесены.
+    // Страница с началом буфера не трогается: перед ней может лежать служебная запись malloc
+    void ReleaseMigratedPages() noexcept {
+#if defined(__linux__)
+        static const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const auto base = reinterpret_cast<uintptr_t>(old_.GetAddress());
+        const uintptr_t first = (base + released_ + page_size - 1) & ~(page_size - 1);
+        const uintptr_t last = (base + migrated_ * sizeof(T)) & ~(page_size - 1);
+        if (last < first + kReleaseBatchBytes) {
+            return;
+        }
+        // При ошибке страницы просто освободятся вместе с буфером
+        madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+        released_ = last - base;
+#endif
+    }
+
+    void FreeOld() noexcept {
+        RawMemory<T>().Swap(old_);
+        old_size_ = 0;
+        migrated_ = 0;
+        released_ = 0;
+    }
+
+    void FinishMigration() {
+        while (IsMigrating()) {
+            MigrateStep();
+        }
+    }
+
+    // Меньшие порции не окупают системный вызов
+    static constexpr size_t kReleaseBatchBytes = 64 * 1024;
+
+    RawMemory<T> data_;
+    RawMemory<T> old_;
+    size_t size_ = 0;
+    // Во время переезда: сколько элементов было в старом буфере и сколько из них уже перенесено
+    size_t old_size_ = 0;
+    size_t migrated_ = 0;
+    // Сколько байт от начала старого буфера уже возвращено системе
+    size_t released_ = 0;
+};
@@ -1,8 +1,35 @@
 #include "vector.h"
+#include "arena.h"
+#include "allocators.h"
+#include "small_vector.h"
+#include "mmap_allocator.h"
+#include "vector_stats.h"
+#include "vector_algorithms.h"
+#include "thread_pool.h"
+#include "numa_allocator.h"
+#include "soa_vector.h"
+#include "mapped_vector.h"
+#include "concurrent_vector.h"
+#include "incremental_vector.h"
+#include "shared_vector.h"
+#include "flat_map.h"
+#include "packed_vector.h"
+#include "buffer_cache.h"
+#include "vector_expr.h"
 
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -98,8 +125,160 @@ struct Obj {
     static inline int num_destroyed = 0;
 };
 
+// Аллокатор с идентификатором и настраиваемым распространением: позволяет проверить,
+// чей аллокатор достался вектору после копирования, перемещения и обмена
+template <typename T, bool Propagate>
+struct TaggedAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+    template <typename U>
+    struct rebind {
+        using other = TaggedAllocator<U, Propagate>;
+    };
+
+    TaggedAllocator() = default;
+    explicit TaggedAllocator(int id)
+        : id(id) {
+    }
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U, Propagate>& other) noexcept
+        : id(other.id) {
+    }
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return static_cast<T*>(operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) noexcept {
+        ++num_deallocations;
+        operator delete(p);
+    }
+
+    TaggedAllocator select_on_container_copy_construction() const {
+        return TaggedAllocator(0);
+    }
+
+    bool operator==(const TaggedAllocator& other) const noexcept {
+        return id == other.id;
+    }
+    bool operator!=(const TaggedAllocator& other) const noexcept {
+        return id != other.id;
+    }
+
+    int id = 0;
+    static inline int num_allocations = 0;
+    static inline int num_deallocations = 0;
+};
+
+// Владеющий дескриптор: перемещение оставляет источник пустым, поэтому тип не
+// тривиально копируемый, но его можно переносить побайтово
+struct Handle {
+    explicit Handle(int value)
+        : ptr(new int(value)) {
+    }
+    Handle(const Handle& other)
+        : ptr(new int(*other.ptr)) {
+    }
+    Handle(Handle&& other) noexcept
+        : ptr(std::exchange(other.ptr, nullptr)) {
+        ++num_moved;
+    }
+    Handle& operator=(Handle other) noexcept {
+        std::swap(ptr, other.ptr);
+        return *this;
+    }
+    ~Handle() {
+        delete ptr;
+    }
+
+    int* ptr = nullptr;
+    static inline int num_moved = 0;
+};
+
+struct alignas(64) Block {
+    int value = 0;
+};
+
+template <typename T>
+bool IsAligned(const T* ptr, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+// Как Obj, но счётчик живых объектов можно менять из нескольких потоков
+struct SharedObj {
+    SharedObj() {
+        ++alive;
+    }
+    explicit SharedObj(int id)
+        : id(id) {
+        ++alive;
+    }
+    SharedObj(const SharedObj& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+    SharedObj(SharedObj&& other) noexcept
+        : id(other.id) {
+        ++alive;
+    }
+    SharedObj& operator=(const SharedObj& other) = default;
+    ~SharedObj() {
+        --alive;
+    }
+
+    bool throw_on_copy = false;
+    int id = 0;
+
+    static inline std::atomic<int> alive{0};
+};
+
+// Перемещение может бросить, поэтому вектор переносит такие элементы копированием
+struct ThrowingMoveObj {
+    explicit ThrowingMoveObj(int id)
+        : id(id) {
+    }
+    ThrowingMoveObj(const ThrowingMoveObj& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+    }
+    ThrowingMoveObj(ThrowingMoveObj&& other)
+        : id(other.id) {
+    }
+
+    bool throw_on_copy = false;
+    int id = 0;
+};
+
+// Вышестоящий ресурс для арены: запоминает размер самого большого запрошенного блока
+struct SizeRecordingResource : std::pmr::memory_resource {
+    size_t max_block_size = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        max_block_size = std::max(max_block_size, bytes);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<Handle> : std::true_type {};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -380,6 +559,1967 @@ void Test5() {
     }
 }
 
+void Test6() {
+    const size_t SIZE = 100;
+    const int ID = 42;
+    {
+        // Вся память берётся из буфера на стеке, вышестоящий ресурс не используется
+        alignas(std::max_align_t) std::byte buffer[4096];
+        MonotonicArena arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::Vector<int> v(&arena);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        assert(v.GetAllocator().resource() == &arena);
+        assert(arena.BytesAllocated() >= SIZE * sizeof(int));
+    }
+    {
+        MonotonicArena arena;
+        pmr::Vector<int> v(SIZE, &arena);
+        arena.Release();
+        assert(arena.BytesAllocated() == 0);
+    }
+    {
+        // После Release() арена начинает снова с начального размера блока
+        SizeRecordingResource upstream;
+        MonotonicArena arena(1024, &upstream);
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 8; ++i) {
+                [[maybe_unused]] void* p = arena.allocate(1000);
+            }
+            arena.Release();
+        }
+        assert(upstream.max_block_size <= 16 * 1024);
+
+        // Запрос, который не помещается ни в один блок, не переполняет арифметику размеров
+        bool thrown = false;
+        try {
+            // volatile прячет размер от компилятора, который иначе предупреждает о нём
+            const volatile size_t huge = std::numeric_limits<size_t>::max() - 8;
+            [[maybe_unused]] void* p = arena.allocate(huge);
+        } catch (const std::bad_alloc&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        Obj::ResetCounters();
+        MonotonicArena arena1;
+        MonotonicArena arena2;
+        pmr::Vector<Obj> v1(SIZE, &arena1);
+        v1[0].id = ID;
+
+        // Копия получает ресурс по умолчанию, присваивание не меняет ресурс получателя
+        pmr::Vector<Obj> copy(v1);
+        assert(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        pmr::Vector<Obj> v2(&arena2);
+        v2 = v1;
+        assert(v2.GetAllocator().resource() == &arena2);
+        assert(v2[0].id == ID);
+
+        // Ресурсы разные, поэтому элементы перемещаются по одному
+        pmr::Vector<Obj> v3(&arena2);
+        const int old_move_count = Obj::num_moved;
+        v3 = std::move(v1);
+        assert(v3.GetAllocator().resource() == &arena2);
+        assert(v3.Size() == SIZE);
+        assert(v3[0].id == ID);
+        assert(Obj::num_moved == old_move_count + static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        using Alloc = TaggedAllocator<int, true>;
+        Vector<int, Alloc> v1(SIZE, Alloc(1));
+        Vector<int, Alloc> v2(SIZE / 2, Alloc(2));
+        v2 = v1;
+        assert(v2.GetAllocator().id == 1);
+        assert(v2.Size() == SIZE);
+
+        Vector<int, Alloc> v3(Alloc(3));
+        v3 = std::move(v1);
+        assert(v3.GetAllocator().id == 1);
+        assert(v3.Size() == SIZE);
+
+        Vector<int, Alloc> v4(Alloc(4));
+        v4.Swap(v3);
+        assert(v4.GetAllocator().id == 1);
+        assert(v3.GetAllocator().id == 4);
+
+        Vector<int, Alloc> copy(v4);
+        assert(copy.GetAllocator().id == 0);
+    }
+    {
+        using Alloc = TaggedAllocator<int, false>;
+        Vector<int, Alloc> v1(SIZE, Alloc(1));
+        Vector<int, Alloc> v2(Alloc(2));
+        v2 = v1;
+        assert(v2.GetAllocator().id == 2);
+        v2 = std::move(v1);
+        assert(v2.GetAllocator().id == 2);
+        assert(v2.Size() == SIZE);
+    }
+    using PropagatingAlloc = TaggedAllocator<int, true>;
+    using StickyAlloc = TaggedAllocator<int, false>;
+    assert(PropagatingAlloc::num_allocations == PropagatingAlloc::num_deallocations);
+    assert(StickyAlloc::num_allocations == StickyAlloc::num_deallocations);
+}
+
+void Test7() {
+    const int SIZE = 1000;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        v.Emplace(v.begin(), -1);
+        v.Insert(v.begin() + SIZE / 2, v[0]);
+        assert(v.Size() == SIZE + 2);
+        assert(v[0] == -1);
+        assert(v[1] == 0);
+        assert(v[SIZE / 2] == -1);
+        assert(v[SIZE + 1] == SIZE - 1);
+
+        v.Erase(v.begin() + SIZE / 2);
+        v.Erase(v.begin());
+        for (int i = 0; i < SIZE; ++i) {
+            assert(v[i] == i);
+        }
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() >= SIZE * 4);
+        assert(v[SIZE - 1] == SIZE - 1);
+    }
+    {
+        // Переезд и сдвиги побайтовые: конструктор перемещения вызывается только при вставке
+        Handle::num_moved = 0;
+        Vector<Handle> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(Handle(i));
+        }
+        assert(Handle::num_moved == SIZE);
+        v.Emplace(v.begin(), -1);
+        v.Reserve(SIZE * 4);
+        v.Erase(v.begin() + 1);
+        assert(Handle::num_moved == SIZE);
+        assert(*v[0].ptr == -1);
+        assert(*v[1].ptr == 1);
+        assert(v.Size() == SIZE);
+
+        // Вставка копии собственного элемента при реаллокации
+        Vector<Handle, MallocAllocator<Handle>> w;
+        w.EmplaceBack(7);
+        w.EmplaceBack(w[0]);
+        w.Emplace(w.begin(), w[1]);
+        assert(*w[0].ptr == 7 && *w[1].ptr == 7 && *w[2].ptr == 7);
+    }
+}
+
+void Test8() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        size_t expected_capacity = 0;
+        for (int i = 0; i < 100; ++i) {
+            if (v.Size() == v.Capacity()) {
+                expected_capacity = OneAndHalfGrowth::NextCapacity(expected_capacity, sizeof(int));
+            }
+            v.PushBack(i);
+            assert(v.Capacity() == expected_capacity);
+        }
+        assert(v.Capacity() < 2 * v.Size());
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, std::allocator<Obj>, MinCapacityGrowth<8>> v;
+        v.EmplaceBack(1);
+        assert(v.Capacity() == 8);
+        for (int i = 0; i < 7; ++i) {
+            v.Emplace(v.begin(), i);
+        }
+        assert(v.Capacity() == 8);
+        assert(Obj::num_moved == 7);
+        v.EmplaceBack(2);
+        assert(v.Capacity() == 16);
+    }
+    {
+        using Growth = PageRoundedGrowth<OneAndHalfGrowth>;
+        Vector<int, std::allocator<int>, Growth> v(3000);
+        v.PushBack(0);
+        assert(v.Capacity() * sizeof(int) % 4096 == 0);
+        assert(v.Capacity() >= 4500);
+
+        // Мелкие буферы не округляются
+        Vector<int, std::allocator<int>, Growth> small;
+        small.PushBack(0);
+        assert(small.Capacity() == 1);
+    }
+    {
+        // Запас, который malloc выделил сверх запрошенного, становится вместимостью:
+        // и при создании, и при росте через realloc, и в Reserve
+        Vector<char, MallocAllocator<char>> v;
+        v.PushBack('a');
+        assert(v.Capacity() >= 1);
+#if defined(__GLIBC__)
+        assert(v.Capacity() == malloc_usable_size(v.begin()));
+#endif
+        size_t capacity = v.Capacity();
+        for (size_t i = 1; i < capacity; ++i) {
+            v.PushBack('b');
+        }
+        assert(v.Capacity() == capacity);
+        v.PushBack('c');
+        assert(v.Capacity() > capacity);
+        const size_t last = capacity;
+        capacity = v.Capacity();
+#if defined(__GLIBC__)
+        assert(capacity == malloc_usable_size(v.begin()));
+#endif
+        v.Reserve(3000);
+        assert(v.Capacity() >= 3000);
+#if defined(__GLIBC__)
+        assert(v.Capacity() == malloc_usable_size(v.begin()));
+#endif
+        assert(v[0] == 'a' && v[last] == 'c');
+
+        Vector<int, MallocAllocator<int>> ints(1);
+        ints.Reserve(1001);
+#if defined(__GLIBC__)
+        assert(ints.Capacity() == malloc_usable_size(ints.begin()) / sizeof(int));
+#endif
+        assert(ints.Capacity() >= 1001);
+    }
+}
+
+void Test9() {
+    const size_t N = 4;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v;
+        for (size_t i = 0; i < N; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(v.Capacity() == N);
+        assert(Obj::num_moved == 0);
+
+        v.EmplaceBack(ID);
+        assert(!v.IsInline());
+        assert(v.Capacity() == N * 2);
+        assert(Obj::num_moved == N);
+        assert(v[N].id == ID);
+
+        v.Emplace(v.begin(), -1);
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == N + 1);
+        assert(v[0].id == -1);
+        assert(v[1].id == 1);
+
+        // Буфер кучи забирается без перемещения элементов
+        const int old_move_count = Obj::num_moved;
+        SmallVector<Obj, N> moved(std::move(v));
+        assert(Obj::num_moved == old_move_count);
+        assert(v.Size() == 0 && v.IsInline());
+        assert(moved[N].id == ID);
+
+        moved.Resize(2);
+        SmallVector<Obj, N> copy(moved);
+        assert(copy.IsInline());
+        moved = copy;
+        v = std::move(copy);
+        assert(v.Size() == 2 && v[1].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Те же гарантии, что проверяет Test2 для Vector, во встроенном режиме и в куче
+        for (size_t size : {N, N * 4}) {
+            Obj::ResetCounters();
+            Obj::default_construction_throw_countdown = static_cast<int>(size / 2);
+            try {
+                SmallVector<Obj, N> v(size);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(Obj::GetAliveObjectCount() == 0);
+
+            Obj::ResetCounters();
+            SmallVector<Obj, N> v(size);
+            v[size / 2].throw_on_copy = true;
+            try {
+                SmallVector<Obj, N> v_copy(v);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+                assert(Obj::num_copied == static_cast<int>(size / 2));
+            }
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(size));
+
+            v[size - 1].throw_on_copy = true;
+            v.Reserve(size * 2);
+            assert(v.Capacity() == size * 2);
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(size));
+        }
+    }
+    {
+        // Вставка собственного элемента при переезде из встроенного буфера в кучу
+        SmallVector<TestObj, 1> v(1);
+        v.PushBack(v[0]);
+        assert(v[0].IsAlive());
+        assert(v[1].IsAlive());
+        SmallVector<TestObj, 1> w(1);
+        w.Emplace(w.begin(), std::move(w[0]));
+        assert(w[0].IsAlive());
+        assert(w[1].IsAlive());
+    }
+    {
+        SmallVector<int, N> v;
+        for (int i = 0; i < 10; ++i) {
+            v.Insert(v.begin(), i);
+        }
+        SmallVector<int, N> w;
+        w.PushBack(ID);
+        v.Swap(w);
+        assert(v.Size() == 1 && v[0] == ID);
+        assert(w.Size() == 10 && w[0] == 9 && w[9] == 0);
+    }
+}
+
+void Test10() {
+    const size_t THRESHOLD = 1 << 16;
+    const int SIZE = 200'000;
+    {
+        // Рост переходит из malloc в mmap, дальше буфер растёт через mremap
+        Vector<int, MmapAllocator<int, THRESHOLD, true>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() * sizeof(int) >= THRESHOLD);
+        v.Emplace(v.begin(), -1);
+        v.Erase(v.begin());
+        // mremap отдаёт вектору все страницы нового блока
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() >= SIZE * 4 && v.Capacity() * sizeof(int) % 4096 == 0);
+        for (int i = 0; i < SIZE; ++i) {
+            assert(v[i] == i);
+        }
+
+        // Копия сразу выделяется через mmap и занимает целые страницы
+        Vector<int, MmapAllocator<int, THRESHOLD, true>> copy(v);
+        assert(copy.Capacity() >= copy.Size());
+        assert(copy.Capacity() * sizeof(int) % static_cast<size_t>(sysconf(_SC_PAGESIZE)) == 0);
+        assert(copy[SIZE - 1] == SIZE - 1);
+    }
+    {
+        // Нетривиально перемещаемые элементы переезжают обычным образом
+        Obj::ResetCounters();
+        Vector<Obj, MmapAllocator<Obj, THRESHOLD>> v;
+        for (int i = 0; i < SIZE / 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v[SIZE / 100 - 1].id == SIZE / 100 - 1);
+        v.Resize(1);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test11() {
+    const size_t SIZE = 1000;
+    {
+        Vector<double> v(SIZE, kDefaultInit);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<double>(i);
+        }
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(v[SIZE - 1] == static_cast<double>(SIZE - 1));
+        v.ResizeDefaultInit(1);
+        assert(v.Size() == 1);
+    }
+    {
+        // Для типов с конструктором по умолчанию он по-прежнему вызывается
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, kDefaultInit);
+        v.ResizeDefaultInit(SIZE + 1);
+        assert(Obj::num_default_constructed == SIZE + 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        const std::string message = "Hello, world";
+        Vector<char> v;
+        v.PushBack('>');
+        char* buf = v.AppendUninitialized(SIZE);
+        assert(v.Size() == 1);
+        assert(v.Capacity() >= SIZE + 1);
+        message.copy(buf, message.size());
+        v.CommitAppend(message.size());
+        assert(v.Size() == message.size() + 1);
+        assert(std::string(v.begin() + 1, v.end()) == message);
+
+        // Места хватает — буфер не переезжает
+        const size_t capacity = v.Capacity();
+        char* tail = v.AppendUninitialized(capacity - v.Size());
+        assert(tail == v.end());
+        assert(v.Capacity() == capacity);
+        v.CommitAppend(0);
+    }
+}
+
+void Test12() {
+    const int ID = 42;
+    {
+        Vector<int> v{1, 2, 3};
+        assert(v.Size() == 3 && v.Capacity() == 3);
+
+        // Одна реаллокация на весь диапазон
+        const int values[] = {10, 11, 12, 13};
+        v.Insert(v.begin() + 1, std::begin(values), std::end(values));
+        assert(v.Size() == 7);
+        assert(v.Capacity() == 7);
+        const Vector<int> expected{1, 10, 11, 12, 13, 2, 3};
+        assert(std::equal(v.begin(), v.end(), expected.begin()));
+
+        // Вставка собственных элементов
+        v.Reserve(100);
+        v.Insert(v.begin(), v.begin() + 4, v.end());
+        const Vector<int> expected_self{13, 2, 3, 1, 10, 11, 12, 13, 2, 3};
+        assert(std::equal(v.begin(), v.end(), expected_self.begin(), expected_self.end()));
+
+        v.Insert(v.begin() + 1, 3, v[0]);
+        assert(v.Size() == 13);
+        assert(v[1] == 13 && v[3] == 13 && v[4] == 2);
+
+        v.Assign({5, 6});
+        assert(v.Size() == 2 && v[1] == 6);
+        assert(v.Capacity() == 100);
+        v.Append({7, 8});
+        assert(v.Size() == 4 && v[3] == 8);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(10);
+        v.Reserve(20);
+        std::list<Obj> src;
+        for (int i = 0; i < 5; ++i) {
+            src.emplace_back(ID + i);
+        }
+
+        // Хвост длиннее вставки
+        v.Insert(v.begin() + 2, src.begin(), src.end());
+        assert(v.Size() == 15 && v.Capacity() == 20);
+        assert(v[1].id == 0 && v[2].id == ID && v[6].id == ID + 4 && v[7].id == 0);
+        // Хвост короче вставки
+        v.Insert(v.begin() + 13, src.begin(), src.end());
+        assert(v.Size() == 20 && v.Capacity() == 20);
+        assert(v[12].id == 0 && v[13].id == ID && v[17].id == ID + 4 && v[18].id == 0);
+
+        v.Append(src.begin(), src.end());
+        assert(v.Size() == 25 && v.Capacity() == 40);
+        assert(v[24].id == ID + 4);
+        assert(Obj::GetAliveObjectCount() == 25 + 5);
+
+        Vector<Obj> from_list(src.begin(), src.end());
+        assert(from_list.Size() == 5 && from_list.Capacity() == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Строгая гарантия при реаллокации: вектор не меняется, если копирование бросило
+        Obj::ResetCounters();
+        Vector<Obj> v(4);
+        v[0].id = ID;
+        Vector<Obj> src(3);
+        src[2].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 1, src.begin(), src.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v.Capacity() == 4);
+        assert(v[0].id == ID);
+        assert(Obj::GetAliveObjectCount() == 7);
+
+        try {
+            Vector<Obj> copy(src.begin(), src.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 7);
+    }
+    {
+        // Входные итераторы читаются за один проход
+        std::istringstream input("4 5 6");
+        Vector<int> v{1, 2, 3};
+        v.Insert(v.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        const Vector<int> expected{1, 4, 5, 6, 2, 3};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+        std::istringstream input2("7 8");
+        v.Assign(std::istream_iterator<int>(input2), std::istream_iterator<int>());
+        assert(v.Size() == 2 && v[0] == 7 && v[1] == 8);
+
+        // Ошибка чтения посреди диапазона, уже после реаллокации: добавленное удаляется
+        std::istringstream broken("4 5 x");
+        broken.exceptions(std::ios::failbit);
+        try {
+            v.Insert(v.begin() + 1, std::istream_iterator<int>(broken), std::istream_iterator<int>());
+            assert(false && "Exception is expected");
+        } catch (const std::ios_base::failure&) {
+        }
+        assert(v.Size() == 2 && v.Capacity() > 2 && v[0] == 7 && v[1] == 8);
+    }
+    {
+        Vector<std::string> v{"a", "b", "c", "d"};
+        v.Insert(v.begin() + 1, 2, v[3]);
+        v.Insert(v.begin() + 3, v.begin(), v.begin() + 2);
+        const Vector<std::string> expected{"a", "d", "d", "a", "d", "b", "c", "d"};
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+    }
+}
+
+void Test13() {
+    // Без статистики вектор не становится больше
+    static_assert(sizeof(Vector<int>) == 3 * sizeof(void*));
+    const int SIZE = 100;
+    using TrackedVector = Vector<Obj, std::allocator<Obj>, DoublingGrowth, CountingVectorStats>;
+    const auto site_of = [](const std::source_location& location, int line_offset = 0) {
+        return std::string(location.file_name()) + ":" + std::to_string(location.line() + line_offset);
+    };
+    {
+        Obj::ResetCounters();
+        std::string site;
+        {
+            TrackedVector v;
+            // Место по умолчанию — строка вызова SetStatsSite
+            v.SetStatsSite();
+            site = site_of(std::source_location::current(), -1);
+            for (int i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(i);
+            }
+        }
+        assert(site.find("main.cpp") != std::string::npos);
+        const auto& counters = CountingVectorStats::Get(site);
+        assert(counters.allocations == 8);
+        assert(counters.allocated_bytes == 255 * sizeof(Obj));
+        assert(counters.growths == 8);
+        assert(counters.moved_elements == 127);
+        assert(counters.copied_elements == 0);
+        assert(counters.destroyed_vectors == 1);
+        assert(counters.FillRatio() == SIZE / 128.0);
+
+        std::ostringstream report;
+        CountingVectorStats::Report(report);
+        assert(report.str().find(site) != std::string::npos);
+    }
+    {
+        // Выделяющие конструкторы и копии относятся к своей строке, а не к оригиналу
+        const auto& unattributed = CountingVectorStats::Get();
+        const uint64_t unattributed_allocations = unattributed.allocations;
+        const uint64_t unattributed_destroyed = unattributed.destroyed_vectors;
+        std::string sized_site;
+        std::string copy_site;
+        {
+            TrackedVector sized(SIZE);
+            sized_site = site_of(std::source_location::current(), -1);
+            TrackedVector copy(sized);
+            copy_site = site_of(std::source_location::current(), -1);
+            assert(copy.Size() == static_cast<size_t>(SIZE));
+
+            // Перемещение уносит место, перемещённый вектор больше ничего не учитывает
+            TrackedVector moved(std::move(sized));
+            sized.Reserve(SIZE);
+        }
+        const auto& sized_counters = CountingVectorStats::Get(sized_site);
+        assert(sized_counters.allocations == 1);
+        assert(sized_counters.allocated_bytes == SIZE * sizeof(Obj));
+        assert(sized_counters.destroyed_vectors == 1);
+        assert(sized_counters.FillRatio() == 1.0);
+
+        const auto& copy_counters = CountingVectorStats::Get(copy_site);
+        assert(copy_counters.allocations == 1);
+        assert(copy_counters.destroyed_vectors == 1);
+
+        assert(unattributed.allocations == unattributed_allocations);
+        assert(unattributed.destroyed_vectors == unattributed_destroyed);
+    }
+    {
+        // Временные векторы присваивания учитываются за получателем и не считаются уничтоженными
+        std::string site;
+        {
+            TrackedVector source(SIZE);
+            TrackedVector target(1);
+            site = site_of(std::source_location::current(), -1);
+            target = source;
+            assert(target.Size() == static_cast<size_t>(SIZE));
+        }
+        const auto& counters = CountingVectorStats::Get(site);
+        assert(counters.allocations == 2);
+        assert(counters.allocated_bytes == (SIZE + 1) * sizeof(Obj));
+        assert(counters.destroyed_vectors == 1);
+    }
+    {
+        const auto& counters = CountingVectorStats::Get();
+        const uint64_t destroyed = counters.destroyed_vectors;
+        const uint64_t growths = counters.growths;
+        {
+            Vector<int, std::allocator<int>, DoublingGrowth, CountingVectorStats> v;
+            v.Reserve(SIZE * 2);
+        }
+        assert(counters.destroyed_vectors == destroyed + 1);
+        assert(counters.growths == growths + 1);
+    }
+}
+
+void Test14() {
+    const int SIZE = 100;
+    {
+        // Буфер учитывает alignof(T) после каждого роста
+        Vector<Block> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(Block{i});
+            assert(IsAligned(&v[0], alignof(Block)));
+        }
+        v.Emplace(v.begin(), Block{-1});
+        v.Reserve(SIZE * 3);
+        assert(IsAligned(&v[0], alignof(Block)));
+        assert(v[0].value == -1 && v[SIZE].value == SIZE - 1);
+
+        SmallVector<Block, 2> small;
+        assert(IsAligned(small.begin(), alignof(Block)));
+        small.Resize(SIZE);
+        assert(IsAligned(small.begin(), alignof(Block)));
+    }
+    {
+        Vector<float, AlignedAllocator<float, 32>> v(SIZE);
+        assert(IsAligned(&v[0], 32));
+        for (int i = 0; i < SIZE * 10; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(IsAligned(&v[0], 32));
+        }
+        const Vector<float, AlignedAllocator<float, 32>> copy(v);
+        assert(IsAligned(&copy[0], 32));
+
+        Vector<char, AlignedAllocator<char>> line(1);
+        assert(IsAligned(&line[0], kCacheLineSize));
+        Vector<Block, AlignedAllocator<Block, 16>> blocks(1);
+        assert(IsAligned(&blocks[0], alignof(Block)));
+    }
+}
+
+void Test15() {
+    const SimdLevel levels[] = {SimdLevel::kScalar, SimdLevel::kSse2, SimdLevel::kAvx2, SimdLevel::kAvx512};
+    const CompareOp ops[] = {CompareOp::kEqual,     CompareOp::kNotEqual, CompareOp::kLess,
+                             CompareOp::kLessEqual, CompareOp::kGreater,  CompareOp::kGreaterEqual};
+    uint32_t seed = 12345;
+    auto next = [&seed] {
+        seed = seed * 1103515245 + 12345;
+        return seed >> 8;
+    };
+    // Длины не кратны ширине регистров, чтобы проверить хвосты
+    for (size_t size : {1, 7, 15, 16, 33, 100, 1001}) {
+        Vector<int32_t> ints;
+        Vector<int32_t> weights;
+        Vector<float> floats;
+        Vector<float> scales;
+        for (size_t i = 0; i < size; ++i) {
+            ints.PushBack(static_cast<int32_t>(next() % 64) - 32);
+            weights.PushBack(static_cast<int32_t>(next()) - (1 << 23));
+            floats.PushBack(static_cast<float>(next() % 1000) / 7.0f - 70.0f);
+            scales.PushBack(static_cast<float>(next() % 100) / 3.0f);
+        }
+        int64_t expected_sum = 0;
+        int64_t expected_dot = 0;
+        for (size_t i = 0; i < size; ++i) {
+            expected_sum += ints[i];
+            expected_dot += static_cast<int64_t>(ints[i]) * weights[i];
+        }
+        const int32_t needle = ints[size - 1];
+        const float float_needle = floats[size / 2];
+        const auto expected_minmax = std::minmax_element(ints.begin(), ints.end());
+        const auto expected_float_minmax = std::minmax_element(floats.begin(), floats.end());
+        const float float_sum = Sum(floats, SimdLevel::kScalar);
+        const float float_dot = Dot(floats, scales, SimdLevel::kScalar);
+
+        for (SimdLevel level : levels) {
+            assert(Find(ints, needle, level) == std::find(ints.begin(), ints.end(), needle));
+            assert(Count(ints, needle, level) == static_cast<size_t>(std::count(ints.begin(), ints.end(), needle)));
+            assert(!Contains(ints, 1000, level));
+            assert(Find(floats, float_needle, level) == std::find(floats.begin(), floats.end(), float_needle));
+            assert(Count(floats, float_needle, level)
+                   == static_cast<size_t>(std::count(floats.begin(), floats.end(), float_needle)));
+
+            assert(MinMax(ints, level) == std::make_pair(*expected_minmax.first, *expected_minmax.second));
+            assert(MinMax(floats, level)
+                   == std::make_pair(*expected_float_minmax.first, *expected_float_minmax.second));
+
+            assert(Sum(ints, level) == expected_sum);
+            assert(Dot(ints, weights, level) == expected_dot);
+            // Порядок сложения одинаков во всех версиях, поэтому float совпадает побитово
+            assert(Sum(floats, level) == float_sum);
+            assert(Dot(floats, scales, level) == float_dot);
+
+            for (CompareOp op : ops) {
+                Vector<int32_t> expected = ints;
+                CompactWhere(expected, op, needle, SimdLevel::kScalar);
+                Vector<int32_t> compacted = ints;
+                assert(CompactWhere(compacted, op, needle, level) == expected.Size());
+                assert(std::equal(compacted.begin(), compacted.end(), expected.begin(), expected.end()));
+
+                Vector<float> expected_floats = floats;
+                CompactWhere(expected_floats, op, float_needle, SimdLevel::kScalar);
+                Vector<float> compacted_floats = floats;
+                assert(CompactWhere(compacted_floats, op, float_needle, level) == expected_floats.Size());
+                assert(std::equal(compacted_floats.begin(), compacted_floats.end(), expected_floats.begin(),
+                                  expected_floats.end()));
+            }
+        }
+        {
+            Vector<int32_t> kept = ints;
+            CompactWhere(kept, CompareOp::kLess, 0);
+            assert(std::all_of(kept.begin(), kept.end(), [](int32_t x) {
+                return x < 0;
+            }));
+            assert(kept.Size() == static_cast<size_t>(std::count_if(ints.begin(), ints.end(), [](int32_t x) {
+                       return x < 0;
+                   })));
+        }
+    }
+    {
+        // Типы без SIMD-ядер обрабатываются обычными циклами
+        Vector<int64_t> v{5, -3, 8, -3};
+        assert(Count(v, int64_t{-3}) == 2);
+        assert(*Find(v, int64_t{8}) == 8);
+        assert(MinMax(v) == std::make_pair(int64_t{-3}, int64_t{8}));
+        assert(Sum(v) == 7);
+        assert(Dot(v, v) == 107);
+        assert(CompactWhere(v, CompareOp::kNotEqual, int64_t{-3}) == 2);
+        assert(v[0] == 5 && v[1] == 8);
+    }
+}
+
+void Test16() {
+    ThreadPool pool(4);
+    const size_t SIZE = 300'000;
+    {
+        std::atomic<size_t> sum{0};
+        pool.ParallelFor(100, [&sum](size_t i) {
+            sum += i;
+        });
+        assert(sum == 4950);
+        try {
+            pool.ParallelFor(100, [](size_t i) {
+                if (i == 50) {
+                    throw std::runtime_error("Oops");
+                }
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+    }
+    {
+        Vector<int> v(SIZE, pool);
+        assert(v.Size() == SIZE);
+        assert(std::all_of(v.begin(), v.end(), [](int x) {
+            return x == 0;
+        }));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+        const Vector<int> copy(v, pool);
+        assert(std::equal(copy.begin(), copy.end(), v.begin(), v.end()));
+
+        Vector<int> small(10);
+        small.Assign(copy, pool);
+        assert(std::equal(small.begin(), small.end(), copy.begin(), copy.end()));
+        Vector<int> half(copy.begin(), copy.begin() + SIZE / 2);
+        small.Assign(half, pool);
+        assert(small.Size() == SIZE / 2 && small.Capacity() >= SIZE);
+        assert(std::equal(small.begin(), small.end(), half.begin(), half.end()));
+        small.Clear(pool);
+        assert(small.Size() == 0);
+    }
+    {
+        Vector<SharedObj> v;
+        v.Reserve(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        Vector<SharedObj> copy(v, pool);
+        assert(SharedObj::alive == static_cast<int>(2 * SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(copy[i].id == static_cast<int>(i));
+        }
+
+        // Исключение в одном куске: созданные элементы всех кусков уничтожаются
+        for (size_t bad : {size_t{0}, SIZE / 2, SIZE - 1}) {
+            v[bad].throw_on_copy = true;
+            try {
+                Vector<SharedObj> failed(v, pool);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(SharedObj::alive == static_cast<int>(2 * SIZE));
+
+            // Присваивание в больший буфер не меняет приёмник
+            Vector<SharedObj> target(10);
+            try {
+                target.Assign(v, pool);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(target.Size() == 10);
+            v[bad].throw_on_copy = false;
+        }
+        assert(SharedObj::alive == static_cast<int>(2 * SIZE));
+
+        copy.Resize(SIZE / 3);
+        copy.Assign(v, pool);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        copy.Clear(pool);
+        assert(SharedObj::alive == static_cast<int>(SIZE));
+        Vector<SharedObj> values(SIZE, pool);
+        assert(SharedObj::alive == static_cast<int>(2 * SIZE));
+    }
+    assert(SharedObj::alive == 0);
+}
+
+void Test17() {
+    assert((numa_detail::ParseList("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    assert(!NumaNodes().empty());
+    const int node = NumaNodes().front();
+    const size_t SIZE = 1 << 20;
+    {
+        Vector<int, NumaAllocator<int>> v(SIZE, NumaAllocator<int>(NumaPolicy::Bind(node)));
+        v[SIZE - 1] = 1;
+        const int placed = NumaNodeOf(&v[0]);
+        assert(placed == node || placed == -1);
+        // Рост через mremap сохраняет содержимое
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(v[SIZE - 1] == 1 && v[SIZE + 999] == 999);
+        assert(v.GetAllocator().GetPolicy() == NumaPolicy::Bind(node));
+    }
+    {
+        using Interleaved = Vector<int, NumaAllocator<int>>;
+        Interleaved source(SIZE, kDefaultInit, NumaAllocator<int>(NumaPolicy::FirstTouch()));
+        for (size_t i = 0; i < SIZE; ++i) {
+            source[i] = static_cast<int>(i);
+        }
+        // Политики разные, поэтому элементы переносятся в новый буфер
+        Interleaved moved(std::move(source), NumaAllocator<int>(NumaPolicy::Interleave()));
+        assert(moved.Size() == SIZE && moved[SIZE / 2] == static_cast<int>(SIZE / 2));
+        assert(moved.GetAllocator().GetPolicy() == NumaPolicy::Interleave());
+    }
+    {
+        // Параллельное создание первым касанием: куски ложатся на узлы по порядку,
+        // а потоки, включая вызывающий, возвращаются к прежним процессорам
+        cpu_set_t before;
+        CPU_ZERO(&before);
+        assert(sched_getaffinity(0, sizeof(before), &before) == 0);
+
+        ThreadPool pool(4);
+        NumaFirstTouchExecutor placed(pool);
+        using Placed = Vector<int, NumaAllocator<int>>;
+        Placed v(SIZE, placed, NumaAllocator<int>(NumaPolicy::FirstTouch()));
+        assert(v.Size() == SIZE && v[0] == 0 && v[SIZE - 1] == 0);
+        assert(NumaFirstTouchExecutor<ThreadPool>::NodeOfChunk(0, 16) == NumaNodes().front());
+        assert(NumaFirstTouchExecutor<ThreadPool>::NodeOfChunk(15, 16) == NumaNodes().back());
+        if (IsNumaSystem()) {
+            assert(NumaNodeOf(&v[0]) == NumaNodes().front());
+            assert(NumaNodeOf(&v[SIZE - 1]) == NumaNodes().back());
+        }
+
+        v[SIZE / 2] = 7;
+        Placed copy(v, placed);
+        assert(copy[SIZE / 2] == 7 && copy.GetAllocator().GetPolicy() == NumaPolicy::FirstTouch());
+        if (IsNumaSystem()) {
+            assert(NumaNodeOf(&copy[SIZE - 1]) == NumaNodes().back());
+        }
+
+        cpu_set_t after;
+        CPU_ZERO(&after);
+        assert(sched_getaffinity(0, sizeof(after), &after) == 0);
+        assert(CPU_EQUAL(&before, &after));
+    }
+    if (!IsNumaSystem()) {
+        assert(!BindThreadToNode(node));
+        int page = 0;
+        assert(!ApplyNumaPolicy(&page, sizeof(page), NumaPolicy::Bind(node)));
+    }
+}
+
+void Test18() {
+    const int SIZE = 100;
+    {
+        SoaVector<float, int, std::string> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<float>(i), i, std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        auto [x, id, name] = v[10];
+        assert(x == 10.0f && id == 10 && name == "10");
+        // Строка возвращается ссылками на элементы столбцов
+        id = -10;
+        assert(std::get<1>(v[10]) == -10);
+
+        std::span<float> xs = v.Column<0>();
+        assert(xs.size() == SIZE && xs.data() == &std::get<0>(v[0]));
+        for (float& value : xs) {
+            value *= 2;
+        }
+        assert(std::get<0>(v[SIZE - 1]) == 2.0f * (SIZE - 1));
+
+        v.Emplace(0, -1.0f, -1, "first");
+        // Аргумент ссылается на элемент, который сдвигается при вставке
+        const size_t middle = v.Size() / 2;
+        v.Emplace(middle, -2.0f, -2, std::get<2>(v[1]));
+        assert(v.Size() == SIZE + 2);
+        assert(std::get<2>(v[0]) == "first" && std::get<2>(v[middle]) == "0");
+        v.Erase(0);
+        v.Erase(middle - 1);
+        assert(v.Size() == SIZE && std::get<2>(v[0]) == "0" && std::get<2>(v[SIZE - 1]) == "99");
+
+        const SoaVector<float, int, std::string> copy = v;
+        int count = 0;
+        for (auto [cx, cid, cname] : copy) {
+            assert(cname == std::to_string(count++));
+        }
+        assert(count == SIZE);
+
+        static_assert(std::random_access_iterator<SoaVector<float, int, std::string>::iterator>);
+        const auto row = std::lower_bound(copy.begin(), copy.end(), 50, [](const auto& lhs, int key) {
+            return std::get<1>(lhs) < key;
+        });
+        assert(row - copy.begin() == 50 && 1 + row > row && row >= copy.begin() && row[-1] == copy[49]);
+
+        v.Resize(SIZE / 2);
+        v.Resize(SIZE);
+        assert(std::get<2>(v[SIZE - 1]).empty() && std::get<1>(v[SIZE - 1]) == 0);
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() >= SIZE * 4 && std::get<2>(v[0]) == "0");
+    }
+    {
+        // Исключение во втором столбце откатывает уже созданный первый
+        Obj::ResetCounters();
+        SoaVector<Obj, Obj> v;
+        v.Reserve(2);
+        v.EmplaceBack(1, 2);
+        v.EmplaceBack(3, 4);
+        Obj bad(5);
+        bad.throw_on_copy = true;
+        const int alive = Obj::GetAliveObjectCount();
+        for (size_t index : {size_t{0}, size_t{2}}) {
+            try {
+                v.Emplace(index, Obj(6), bad);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 2 && v.Capacity() == 2);
+            assert(std::get<0>(v[0]).id == 1 && std::get<1>(v[1]).id == 4);
+            assert(Obj::GetAliveObjectCount() == alive);
+        }
+
+        Obj::default_construction_throw_countdown = 4;
+        try {
+            v.Resize(5);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 2 && Obj::GetAliveObjectCount() == alive);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Перемещение столбца может бросить: строки переезжают целиком, и исключение
+        // не перемешивает поля разных строк
+        SoaVector<int, ThrowingMoveObj> v;
+        v.Reserve(8);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i, ThrowingMoveObj(i));
+        }
+        std::get<1>(v[2]).throw_on_copy = true;
+        try {
+            v.Emplace(1, 10, ThrowingMoveObj(10));
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        try {
+            v.Erase(1);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v.Capacity() == 8);
+        for (int i = 0; i < 4; ++i) {
+            assert(std::get<0>(v[i]) == i && std::get<1>(v[i]).id == i);
+        }
+
+        std::get<1>(v[2]).throw_on_copy = false;
+        v.Emplace(1, 10, ThrowingMoveObj(10));
+        v.Erase(3);
+        assert(v.Size() == 4 && v.Capacity() == 8);
+        const int expected[] = {0, 10, 1, 3};
+        for (int i = 0; i < 4; ++i) {
+            assert(std::get<0>(v[i]) == expected[i] && std::get<1>(v[i]).id == expected[i]);
+        }
+    }
+}
+
+void Test19() {
+    struct Entry {
+        uint64_t key;
+        double value;
+    };
+    const std::string path =
+        (std::filesystem::temp_directory_path() / ("mapped_vector_test_" + std::to_string(getpid()))).string();
+    std::remove(path.c_str());
+    const int SIZE = 10000;
+    {
+        MappedVector<Entry> v(path);
+        assert(v.Size() == 0 && !v.IsReadOnly());
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(Entry{static_cast<uint64_t>(i), i * 0.5});
+        }
+        // Аргумент ссылается на элемент, который переезжает при росте
+        while (v.Size() != v.Capacity()) {
+            v.PushBack(Entry{});
+        }
+        v.PushBack(v[0]);
+        assert(v[v.Size() - 1].key == 0);
+        v.PopBack();
+        v.Resize(SIZE);
+        v.Flush();
+    }
+    {
+        // Повторное открытие не разбирает данные: размер и элементы берутся из файла
+        MappedVector<Entry> v(path);
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        assert(v[SIZE - 1].key == SIZE - 1 && v[SIZE - 1].value == (SIZE - 1) * 0.5);
+        v.EmplaceBack(Entry{42, 4.2});
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() >= SIZE * 4 && v.Size() == SIZE + 1);
+    }
+    {
+        const MappedVector<Entry> v(path, MapMode::kReadOnly);
+        assert(v.IsReadOnly() && v.Size() == SIZE + 1);
+        uint64_t sum = 0;
+        for (const Entry& entry : v) {
+            sum += entry.key;
+        }
+        assert(sum == uint64_t{SIZE} * (SIZE - 1) / 2 + 42);
+
+        MappedVector<Entry> moved(path, MapMode::kReadOnly);
+        MappedVector<Entry> target(std::move(moved));
+        assert(moved.Size() == 0 && target.Size() == SIZE + 1);
+
+        // Изменения только для чтения отклоняются исключением и с NDEBUG
+        try {
+            target.PushBack(Entry{1, 1.0});
+            assert(false);
+        } catch (const std::logic_error&) {
+        }
+        try {
+            target.Resize(1);
+            assert(false);
+        } catch (const std::logic_error&) {
+        }
+        try {
+            target.PopBack();
+            assert(false);
+        } catch (const std::logic_error&) {
+        }
+        assert(target.Size() == SIZE + 1 && target[SIZE].key == 42);
+    }
+    try {
+        // Файл с другим размером элемента не открывается
+        MappedVector<uint32_t> wrong(path, MapMode::kReadOnly);
+        assert(false);
+    } catch (const std::runtime_error&) {
+    }
+    std::remove(path.c_str());
+}
+
+void Test20() {
+    {
+        ConcurrentVector<std::string, 4> v;
+        std::string& first = v.EmplaceBack("first");
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        // Элементы не переезжают при росте
+        assert(&first == &v[0] && first == "first");
+        assert(v.Size() == 1001 && v[1000] == "999");
+        int count = 0;
+        for (const std::string& value : v) {
+            count += !value.empty();
+        }
+        assert(count == 1001);
+
+        static_assert(std::random_access_iterator<ConcurrentVector<std::string, 4>::iterator>);
+        static_assert(std::random_access_iterator<ConcurrentVector<std::string, 4>::const_iterator>);
+        auto it = v.end() - 1;
+        it -= 999;
+        assert(*it == "0" && it - 1 == v.begin() && 1 + v.begin() <= it && it < v.end());
+    }
+    {
+        const int THREADS = 4;
+        const int PER_THREAD = 20000;
+        ConcurrentVector<int> v;
+        std::atomic<bool> done{false};
+        std::vector<int*> addresses(THREADS);
+
+        // Читатель видит только полностью созданные элементы
+        std::thread reader([&] {
+            while (!done) {
+                const size_t size = v.Size();
+                for (size_t i = 0; i < size; i += 97) {
+                    assert(v[i] >= 0 && v[i] < THREADS * PER_THREAD);
+                }
+            }
+        });
+        std::vector<std::thread> writers;
+        for (int t = 0; t < THREADS; ++t) {
+            writers.emplace_back([&, t] {
+                addresses[t] = &v.EmplaceBack(t * PER_THREAD);
+                for (int i = 1; i < PER_THREAD; ++i) {
+                    v.PushBack(t * PER_THREAD + i);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        done = true;
+        reader.join();
+
+        assert(v.Size() == THREADS * PER_THREAD);
+        std::vector<int> values(v.begin(), v.end());
+        std::sort(values.begin(), values.end());
+        for (int i = 0; i < THREADS * PER_THREAD; ++i) {
+            assert(values[i] == i);
+        }
+        for (int t = 0; t < THREADS; ++t) {
+            assert(*addresses[t] == t * PER_THREAD);
+        }
+    }
+    {
+        // Исключение конструктора не оставляет незаполненного места
+        SharedObj bad;
+        bad.throw_on_copy = true;
+        ConcurrentVector<SharedObj, 2> v;
+        v.Reserve(10);
+        v.EmplaceBack(1);
+        try {
+            v.PushBack(bad);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        v.EmplaceBack(2);
+        assert(v.Size() == 2 && v[1].id == 2);
+    }
+    assert(SharedObj::alive == 0);
+}
+
+void Test21() {
+    const size_t STEP = 2;
+    Obj::ResetCounters();
+    {
+        IncrementalVector<Obj, STEP> v;
+        for (int i = 0; i < 64; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Size() == 64 && v.Capacity() == 64 && !v.IsMigrating());
+
+        // Рост не переносит элементы сразу: старый буфер переезжает по STEP элементов за вставку
+        const int moved = Obj::num_moved;
+        v.EmplaceBack(64);
+        assert(v.IsMigrating() && v.Capacity() == 128 && Obj::num_moved == moved);
+        int pushes = 0;
+        while (v.IsMigrating()) {
+            const int before = Obj::num_moved;
+            v.PushBack(Obj(65 + pushes));
+            // Один перенос самого аргумента плюс не более STEP перенесённых элементов
+            assert(Obj::num_moved - before <= static_cast<int>(STEP) + 1);
+            ++pushes;
+            for (size_t i = 0; i < v.Size(); ++i) {
+                assert(v[i].id == static_cast<int>(i));
+            }
+        }
+        assert(pushes == 32 && Obj::num_copied == 0);
+
+        // Удаление во время переезда, в том числе ещё не перенесённых элементов
+        while (v.Size() != v.Capacity()) {
+            v.EmplaceBack(static_cast<int>(v.Size()));
+        }
+        for (int i = 0; i < 11; ++i) {
+            v.EmplaceBack(static_cast<int>(v.Size()));
+        }
+        assert(v.IsMigrating());
+        while (v.Size() > 50) {
+            v.PopBack();
+        }
+        assert(v.IsMigrating());
+        int expected = 0;
+        for (const Obj& obj : v) {
+            assert(obj.id == expected++);
+        }
+        assert(Obj::GetAliveObjectCount() == 50);
+        while (v.IsMigrating()) {
+            v.EmplaceBack(static_cast<int>(v.Size()));
+        }
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+
+        // Аргумент может ссылаться на элемент самого вектора
+        while (v.Size() != v.Capacity()) {
+            v.EmplaceBack(0);
+        }
+        v.PushBack(v[3]);
+        assert(v.IsMigrating() && v[v.Size() - 1].id == 3);
+        // ...и на ещё не перенесённый элемент, который переедет этой же вставкой
+        v.PushBack(v[5]);
+        assert(v.IsMigrating() && v[v.Size() - 1].id == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Последний шаг переезда освобождает старый буфер, из которого читается аргумент
+        IncrementalVector<int> v;
+        for (int i = 0; i < 8; ++i) {
+            v.PushBack(i);
+        }
+        v.PushBack(8);
+        v.PushBack(9);
+        assert(v.IsMigrating());
+        v.PushBack(v[7]);
+        assert(!v.IsMigrating() && v.Size() == 11 && v[10] == 7);
+
+        // Шаг 1: вектор заполняется раньше, чем заканчивается переезд
+        IncrementalVector<Obj, 1> w;
+        w.EmplaceBack(0);
+        w.PushBack(w[0]);
+        assert(w.IsMigrating() && w.Size() == w.Capacity());
+        w.PushBack(w[0]);
+        assert(w.Size() == 3 && w.Capacity() == 4 && w[0].id == 0 && w[2].id == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Перенесённые страницы большого старого буфера возвращаются системе по ходу переезда
+        IncrementalVector<uint64_t> v;
+        const size_t size = size_t{1} << 20;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(i);
+        }
+        v.PushBack(size);
+        for (size_t i = 0; i < size / 8; ++i) {
+            v.PushBack(size + 1 + i);
+        }
+        assert(v.IsMigrating());
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == i);
+        }
+
+        // PopBack, удаливший все неперенесённые элементы, заканчивает переезд
+        while (v.IsMigrating()) {
+            v.PopBack();
+        }
+        assert(v.Size() == size / 2 && v[v.Size() - 1] == v.Size() - 1);
+        while (v.Size() != v.Capacity()) {
+            v.PushBack(v.Size());
+        }
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i] == i);
+        }
+    }
+    {
+        IncrementalVector<int> v;
+        v.Reserve(10);
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        v.Reserve(5000);
+        assert(!v.IsMigrating() && v.Capacity() == 5000);
+        IncrementalVector<int> moved(std::move(v));
+        assert(moved.Size() == 1000 && moved[999] == 999 && v.Size() == 0);
+
+        static_assert(std::random_access_iterator<IncrementalVector<int>::iterator>);
+        static_assert(std::random_access_iterator<IncrementalVector<int>::const_iterator>);
+        const auto& cmoved = moved;
+        assert(std::lower_bound(cmoved.begin(), cmoved.end(), 500) - cmoved.begin() == 500);
+        auto it = moved.end() - 1;
+        assert(*it-- == 999 && it[-1] == 997 && 2 + it > it && *(it -= 8) == 990);
+    }
+}
+
+void Test22() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v(100);
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 100 && Obj::GetAliveObjectCount() == 0);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.Capacity() == 10 && Obj::GetAliveObjectCount() == 10);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0 && v.begin() == nullptr);
+    }
+    {
+        // ShrinkToFit даёт строгую гарантию: элементы с бросающим перемещением копируются
+        Vector<ThrowingMoveObj> v;
+        v.Reserve(10);
+        v.EmplaceBack(1);
+        v.EmplaceBack(2);
+        v[1].throw_on_copy = true;
+        try {
+            v.ShrinkToFit();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == 10 && v.Size() == 2 && v[0].id == 1 && v[1].id == 2);
+        v[1].throw_on_copy = false;
+        v.ShrinkToFit();
+        assert(v.Capacity() == 2 && v[1].id == 2);
+    }
+    {
+        // Сжатие после 2 подряд проверок с занятостью не больше четверти, буферы от 64 байт
+        using ShrinkingVector = Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats, HysteresisShrink<4, 2, 64>>;
+        ShrinkingVector v;
+        v.Resize(1000);
+        v.Resize(600);
+        v.Resize(300);
+        assert(v.Capacity() == 1000);
+        for (int cycle = 0; cycle < 10; ++cycle) {
+            // Колебания размера в пределах гистерезиса не перевыделяют память
+            v.Resize(1000);
+            v.Clear();
+        }
+        assert(v.Capacity() == 1000);
+        v.Resize(200);
+        v.PopBack();
+        assert(v.Capacity() == 1000);
+        // PopBack и Erase только копят просьбу политики, ужимает буфер следующий Resize
+        v.PopBack();
+        assert(v.Capacity() == 1000);
+        v.Resize(197);
+        assert(v.Capacity() == 2 * 197 && v.Size() == 197);
+        // Рост сбрасывает счётчик подряд идущих проверок
+        v.Resize(300);
+        v.Resize(1000);
+        v.PopBack();
+        v.Resize(100);
+        v.Resize(16);
+        assert(v.Capacity() == 32 && v.Size() == 16);
+        for (int cycle = 0; cycle < 3; ++cycle) {
+            v.Clear();
+        }
+        assert(v.Capacity() == 16);
+    }
+    {
+        // Итератор, который возвращает Erase, и итераторы перед удалённым местом остаются
+        // действительными, сколько бы раз политика ни попросила ужать буфер
+        using ShrinkingVector = Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats, HysteresisShrink<4, 1, 64>>;
+        ShrinkingVector v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        const int* data = v.begin();
+        const auto first = v.begin();
+        auto it = v.begin() + 10;
+        while (it != v.end()) {
+            it = v.Erase(it);
+        }
+        assert(v.Size() == 10 && v.begin() == data && first == data && it == v.end());
+        v.PopBack();
+        v.EraseUnordered(v.begin());
+        assert(v.EraseIf([](int value) { return value > 5; }) == 3);
+        assert(v.Size() == 5 && v.Capacity() == 1024 && v.begin() == data);
+        v.Clear();
+        assert(v.Capacity() == 16);
+    }
+    {
+        // Большой буфер не переезжает, а отдаёт страницы системе
+        using ReleasingVector =
+            Vector<uint64_t, std::allocator<uint64_t>, DoublingGrowth, NoVectorStats, HysteresisShrink<4, 1, 64, 1 << 20>>;
+        const size_t size = (4 << 20) / sizeof(uint64_t);
+        ReleasingVector v(size);
+        const uint64_t* data = v.begin();
+        v.Resize(10);
+        assert(v.Capacity() == size && v.begin() == data);
+        Vector<uint64_t> plain(size);
+        plain.Resize(1);
+        assert(plain.ReleaseUnusedPages() >= (4 << 20) - 8192);
+        assert(plain.ReleaseUnusedPages() != 0);
+        plain.Resize(size);
+        assert(plain[size - 1] == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test23() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> data;
+        for (int i = 0; i < 10; ++i) {
+            data.EmplaceBack(i);
+        }
+        SharedVector<Obj> table(std::move(data));
+        const int copied = Obj::num_copied;
+
+        // Копии и чтение не копируют элементы
+        SharedVector<Obj> snapshot = table;
+        SharedVector<Obj> another;
+        another = snapshot;
+        int sum = 0;
+        for (const Obj& obj : snapshot) {
+            sum += obj.id;
+        }
+        assert(sum == 45 && Obj::num_copied == copied && table.UseCount() == 3);
+        assert(snapshot.begin() == table.begin());
+
+        // Первая запись копирует буфер, остальные владельцы его не видят
+        table.Mutable(0).id = 100;
+        assert(Obj::num_copied == copied + 10 && table.IsUnique() && snapshot.UseCount() == 2);
+        assert(table[0].id == 100 && snapshot[0].id == 0);
+        table.MakeUnique()[1].id = 101;
+        assert(Obj::num_copied == copied + 10);
+
+        // Аргумент может ссылаться на разделённый буфер
+        another.PushBack(another[9]);
+        assert(another.Size() == 11 && another[10].id == 9 && snapshot.Size() == 10);
+
+        snapshot.Clear();
+        assert(snapshot.Size() == 0 && another.IsUnique());
+        snapshot.EmplaceBack(7);
+        assert(snapshot.Size() == 1 && snapshot[0].id == 7);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Один писатель публикует снимки, читатели берут их под мьютексом за O(1) и читают без него
+        const int VERSIONS = 200;
+        const size_t SIZE = 1000;
+        std::mutex mutex;
+        SharedVector<int> published{Vector<int>(SIZE)};
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; ++t) {
+            readers.emplace_back([&] {
+                int last_version = 0;
+                while (!done) {
+                    SharedVector<int> snapshot;
+                    {
+                        std::lock_guard guard(mutex);
+                        snapshot = published;
+                    }
+                    const int version = snapshot[0];
+                    assert(version >= last_version);
+                    for (int value : snapshot) {
+                        assert(value == version);
+                    }
+                    last_version = version;
+                }
+            });
+        }
+
+        SharedVector<int> table;
+        {
+            std::lock_guard guard(mutex);
+            table = published;
+        }
+        for (int version = 1; version <= VERSIONS; ++version) {
+            for (size_t i = 0; i < SIZE; ++i) {
+                table.Mutable(i) = version;
+            }
+            std::lock_guard guard(mutex);
+            published = table;
+        }
+        done = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(published[SIZE - 1] == VERSIONS && published.UseCount() == 2);
+    }
+}
+
+void Test24() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        v.Reserve(20);
+        for (int i = 0; i < 20; ++i) {
+            v.EmplaceBack(i);
+        }
+        // Диапазон удаляется одним сдвигом хвоста, без создания новых объектов
+        const int destroyed = Obj::num_destroyed;
+        auto it = v.Erase(v.begin() + 2, v.begin() + 5);
+        assert(it == v.begin() + 2 && it->id == 5 && v.Size() == 17);
+        assert(Obj::num_destroyed == destroyed + 3 && Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(v.Erase(v.begin() + 4, v.begin() + 4) == v.begin() + 4 && v.Size() == 17);
+        it = v.Erase(v.begin() + 15, v.end());
+        assert(it == v.end() && v.Size() == 15 && v[14].id == 17);
+
+        // Чётные удаляются за один проход, хвост уничтожается один раз
+        const int before = Obj::num_destroyed;
+        const size_t removed = v.EraseIf([](const Obj& obj) {
+            return obj.id % 2 == 0;
+        });
+        assert(removed == 7 && v.Size() == 8 && Obj::num_destroyed == before + 7);
+        int expected = 1;
+        for (const Obj& obj : v) {
+            assert(obj.id == expected);
+            expected += 2;
+            if (expected == 3) {
+                expected = 5;
+            }
+        }
+        assert(v.EraseIf([](const Obj&) {
+                   return false;
+               }) == 0);
+
+        // Неупорядоченное удаление переносит на место элемента последний
+        it = v.EraseUnordered(v.begin() + 1);
+        assert(it->id == 17 && v.Size() == 7 && v[6].id == 15);
+        it = v.EraseUnordered(v.begin() + 6);
+        assert(it == v.end() && v.Size() == 6);
+        assert(Obj::num_moved == 0 && Obj::GetAliveObjectCount() == 6);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Побайтово переносимые элементы: удаляемые уничтожаются, остальные переезжают memmove
+        Vector<Handle> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Erase(v.begin() + 1, v.begin() + 3);
+        assert(v.Size() == 8 && *v[1].ptr == 3);
+        v.EraseUnordered(v.begin());
+        assert(v.Size() == 7 && *v[0].ptr == 9);
+        // Исключение предиката: уже удалённые элементы удалены, остальные на месте
+        try {
+            v.EraseIf([](const Handle& h) {
+                if (*h.ptr == 6) {
+                    throw std::runtime_error("Oops");
+                }
+                return *h.ptr % 2 == 1;
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        // Было 9 3 4 5 6 7 8: удалены 9, 3 и 5
+        assert(v.Size() == 4 && *v[0].ptr == 4 && *v[1].ptr == 6 && *v[3].ptr == 8);
+        assert(v.EraseIf([](const Handle& h) {
+                   return *h.ptr < 8;
+               }) == 3);
+        assert(v.Size() == 1 && *v[0].ptr == 8);
+    }
+}
+
+// Vector в константных выражениях: память выделяется и освобождается в ходе одного вычисления,
+// результат копируется в std::array
+template <size_t N>
+constexpr std::array<uint32_t, N> MakeCrcTable() {
+    Vector<uint32_t> table;
+    for (uint32_t i = 0; i < N; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table.PushBack(crc);
+    }
+    std::array<uint32_t, N> result{};
+    std::copy(table.begin(), table.end(), result.begin());
+    return result;
+}
+
+constexpr std::array<uint32_t, 256> kCrcTable = MakeCrcTable<256>();
+static_assert(kCrcTable[0] == 0 && kCrcTable[1] == 0x77073096u && kCrcTable[255] == 0x2D02EF8Du);
+
+static_assert([] {
+    // Вставка, удаление и переезд тривиально копируемых элементов
+    Vector<int> v{5, 1, 4};
+    v.Insert(v.begin() + 1, {2, 3});
+    v.Emplace(v.begin(), 0);
+    v.Erase(v.begin() + 4);
+    v.Insert(v.begin() + 2, v.begin(), v.begin() + 3);
+    // 0 5 0 5 2 2 3 4
+    v.EraseIf([](int x) {
+        return x == 5;
+    });
+    v.EraseUnordered(v.begin());
+    Vector<int> copy = v;
+    copy.Resize(10);
+    copy.ShrinkToFit();
+    return v.Size() == 5 && v[0] == 4 && v[1] == 0 && v[4] == 3 && copy.Capacity() == 10 && copy[9] == 0;
+}());
+
+static_assert([] {
+    // Элементы с нетривиальными конструкторами и деструктором
+    Vector<Vector<int>> rows;
+    for (int i = 0; i < 5; ++i) {
+        rows.EmplaceBack(static_cast<size_t>(i));
+    }
+    rows.Insert(rows.begin() + 1, rows[4]);
+    rows.Erase(rows.begin() + 2, rows.begin() + 4);
+    Vector<Vector<int>> moved(std::move(rows));
+    moved.Reserve(100);
+    size_t total = 0;
+    for (const Vector<int>& row : moved) {
+        total += row.Size();
+    }
+    return moved.Size() == 4 && total == 0 + 4 + 3 + 4 && rows.Size() == 0;
+}());
+
+void Test25() {
+    // Таблица из статической памяти, без работы при запуске
+    static constexpr auto table = MakeCrcTable<16>();
+    assert(table[8] == kCrcTable[8] && table.size() == 16);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (char c : std::string("123456789")) {
+        crc = kCrcTable[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+    }
+    assert((crc ^ 0xFFFFFFFFu) == 0xCBF43926u);
+}
+
+void Test26() {
+    {
+        // Пакетная сборка: сортировка и удаление повторов один раз
+        FlatSet<int> set(Vector<int>{5, 1, 9, 1, 3, 5, 7});
+        assert(set.Size() == 5 && std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains(3) && !set.Contains(4) && set.Find(4) == set.end() && *set.Find(9) == 9);
+        assert(set.LowerBound(0) == 0 && set.LowerBound(4) == 2 && set.LowerBound(10) == 5);
+
+        assert(set.Insert(4) && !set.Insert(4) && set.Size() == 6);
+        const Vector<int> batch{8, 2, 9, 2, 0, 11};
+        assert(set.Insert(batch.begin(), batch.end()) == 4);
+        // 0 1 2 3 4 5 7 8 9 11
+        assert(set.Size() == 10 && std::is_sorted(set.begin(), set.end()));
+        const Vector<int> doomed{11, 0, 6, 4, 4};
+        assert(set.EraseKeys(doomed.begin(), doomed.end()) == 3);
+        assert(set.Erase(7) && !set.Erase(7));
+        assert(set.Size() == 6 && set.Keys()[0] == 1 && set.Keys()[5] == 9);
+
+        // Обе раскладки дают одинаковый ответ для каждого ключа, включая отсутствующие
+        for (size_t n = 0; n < 70; ++n) {
+            Vector<int> keys;
+            for (size_t i = 0; i < n; ++i) {
+                keys.PushBack(static_cast<int>(i * 3));
+            }
+            FlatSet<int> sorted(keys);
+            FlatSet<int> eytzinger(keys);
+            eytzinger.SetSearchLayout(SearchLayout::kEytzinger);
+            for (int key = -2; key <= static_cast<int>(n * 3) + 2; ++key) {
+                const size_t expected = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+                assert(sorted.LowerBound(key) == expected && eytzinger.LowerBound(key) == expected);
+            }
+        }
+        // Индекс перестраивается после изменений
+        set.SetSearchLayout(SearchLayout::kEytzinger);
+        set.Insert({6, 100});
+        assert(set.Contains(6) && set.Contains(100) && set.LowerBound(50) == 7);
+    }
+    {
+        // Индекс строится копирующим присваиванием ключей; если оно бросит, поиск
+        // переходит на отсортированный массив и не опирается на устаревший индекс
+        struct FragileKey {
+            FragileKey() = default;
+            FragileKey(int value, const bool* fail)
+                : value(value)
+                , fail(fail) {
+            }
+            FragileKey(const FragileKey&) = default;
+            FragileKey(FragileKey&&) = default;
+            FragileKey& operator=(FragileKey&&) = default;
+            FragileKey& operator=(const FragileKey& other) {
+                if (other.fail != nullptr && *other.fail) {
+                    throw std::runtime_error("Oops");
+                }
+                value = other.value;
+                fail = other.fail;
+                return *this;
+            }
+            bool operator<(const FragileKey& other) const {
+                return value < other.value;
+            }
+
+            int value = 0;
+            const bool* fail = nullptr;
+        };
+        bool fail = false;
+        FlatSet<FragileKey> set;
+        for (int i = 0; i < 20; ++i) {
+            set.Insert(FragileKey(i * 2, &fail));
+        }
+        set.SetSearchLayout(SearchLayout::kEytzinger);
+        fail = true;
+        try {
+            set.Insert(FragileKey(-1, &fail));
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        fail = false;
+        assert(set.GetSearchLayout() == SearchLayout::kSorted && set.Size() == 21);
+        assert(set.Contains(FragileKey(-1, nullptr)) && set.LowerBound(FragileKey(38, nullptr)) == 20);
+    }
+    {
+        FlatMap<std::string, int> map({{"b", 2}, {"a", 1}, {"c", 3}, {"a", 10}});
+        // Из повторов остаётся первое значение
+        assert(map.Size() == 3 && map.At("a") == 1 && map.Keys()[2] == "c" && map.Values()[1] == 2);
+        assert(map.Find("z") == nullptr && !map.Contains("z"));
+        try {
+            map.At("z");
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+
+        assert(map.Insert("d", 4) && !map.Insert("d", 40) && map.At("d") == 4);
+        map.At("b") = 20;
+        const Vector<std::pair<std::string, int>> batch{{"e", 5}, {"a", 100}, {"aa", 11}, {"e", 50}};
+        map.SetSearchLayout(SearchLayout::kEytzinger);
+        assert(map.Insert(batch.begin(), batch.end()) == 2);
+        // a aa b c d e: существующие значения не перезаписываются
+        assert(map.Size() == 6 && map.At("a") == 1 && map.At("aa") == 11 && map.At("e") == 5 && map.At("b") == 20);
+        const Vector<std::string> doomed{"aa", "c", "x"};
+        assert(map.EraseKeys(doomed.begin(), doomed.end()) == 2);
+        assert(map.Erase("a") && !map.Erase("a"));
+        assert(map.Size() == 3 && map.Keys()[0] == "b" && map.Values()[0] == 20 && map.Values()[2] == 5);
+        assert(*map.Find("d") == 4 && map.Find("c") == nullptr);
+    }
+}
+
+void Test27() {
+    {
+        BitVector bits(130);
+        assert(bits.Size() == 130 && bits.Count() == 0 && bits.Capacity() >= 130);
+        bits[0] = true;
+        bits.Set(64);
+        bits[129] = bits[0];
+        bits.Flip(3);
+        assert(bits[0] && bits[3] && bits[64] && bits[129] && !bits[1]);
+        assert(bits.Count() == 4 && bits.Rank(4) == 2 && bits.Rank(130) == 4);
+        assert(bits.Select(0) == 0 && bits.Select(2) == 64 && bits.Select(3) == 129 && bits.Select(4) == 130);
+        assert(bits.FindNext(4) == 64 && bits.FindNext(65) == 129 && bits.FindNext(130) == 130);
+
+        // Биты за концом остаются нулевыми: Flip всего вектора не задевает хвост слова
+        bits.Flip();
+        assert(bits.Count() == 126 && bits.Words().size() == 3 && (bits.Words()[2] >> 2) == 0);
+        bits.Resize(200, true);
+        assert(bits.Count() == 196 && bits[199]);
+        bits.Resize(66);
+        bits.Resize(128);
+        assert(bits.Count() == 63 && !bits[100]);
+        bits.PopBack();
+        bits.PushBack(true);
+        assert(bits.Size() == 128 && bits[127] && bits.Count() == 64);
+
+        // Индекс рангов даёт те же ответы, что и просмотр слов
+        BitVector sparse(5000);
+        for (size_t i = 0; i < sparse.Size(); i += 7) {
+            sparse[i] = true;
+        }
+        sparse.BuildRankIndex();
+        for (size_t i = 0; i <= sparse.Size(); i += 13) {
+            assert(sparse.Rank(i) == (i + 6) / 7);
+        }
+        for (size_t k = 0; k < 715; k += 11) {
+            assert(sparse.Select(k) == k * 7);
+        }
+        assert(sparse.Rank(sparse.Size()) == 715 && sparse.Select(715) == 5000);
+        sparse.Set(1, true);
+        assert(sparse.Rank(8) == 3);
+
+        BitVector mask(5000, true);
+        mask.Resize(2500);
+        mask.Resize(5000);
+        BitVector both = sparse;
+        both &= mask;
+        assert(both.Count() == 359 && both != sparse);
+        both |= sparse;
+        assert(both == sparse);
+        both ^= sparse;
+        assert(both.Count() == 0);
+
+        size_t ones = 0;
+        for (bool bit : BitVector{true, false, true, true}) {
+            ones += bit;
+        }
+        assert(ones == 3);
+        BitVector moved(std::move(sparse));
+        assert(moved.Count() == 716 && sparse.Size() == 0);
+    }
+    {
+        // 17 бит: значения пересекают границы слов
+        PackedIntVector<17> ids;
+        for (uint32_t i = 0; i < 1000; ++i) {
+            ids.PushBack(i * 131 % 100'000);
+        }
+        assert(ids.Size() == 1000 && ids[999] == 999 * 131 % 100'000 && ids.Capacity() >= 1000);
+        ids[500] = 131'071;
+        assert(ids[500] == 131'071 && ids[499] == 499 * 131 % 100'000 && ids[501] == 501 * 131 % 100'000);
+        try {
+            ids.PushBack(131'072);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        assert(ids.Size() == 1000);
+
+        // Распаковка блоками совпадает с поэлементным чтением при любом выравнивании
+        Vector<uint32_t> decoded(1000);
+        for (size_t first : {0, 1, 63, 64, 100}) {
+            ids.Decode(first, 1000 - first, decoded.begin());
+            for (size_t i = first; i < 1000; ++i) {
+                assert(decoded[i - first] == ids[i]);
+            }
+        }
+        const Vector<uint32_t> all = ids.Decode();
+        assert(all.Size() == 1000 && all[500] == 131'071);
+
+        // Сдвиг: идентификаторы около 4 млрд помещаются в 8 бит
+        PackedIntVector<8> offsets{4'000'000'100u, 4'000'000'000u, 4'000'000'255u};
+        assert(offsets.Base() == 4'000'000'000u && offsets[0] == 4'000'000'100u && offsets[2] == 4'000'000'255u);
+        offsets.Resize(200);
+        assert(offsets[199] == 4'000'000'000u);
+        Vector<uint32_t> values(200);
+        offsets.Decode(0, 200, values.begin());
+        assert(values[0] == 4'000'000'100u && values[128] == 4'000'000'000u);
+        offsets.PopBack();
+        PackedIntVector<8> copy = offsets;
+        assert(copy.Size() == 199 && copy[2] == 4'000'000'255u && copy.Base() == offsets.Base());
+
+        // Однопроходный диапазон: база считается по той же последовательности, что и элементы
+        std::istringstream input("4000000100 4000000000 4000000255");
+        const PackedIntVector<8> streamed{std::istream_iterator<uint32_t>(input), std::istream_iterator<uint32_t>()};
+        assert(streamed.Size() == 3 && streamed.Base() == 4'000'000'000u && streamed[2] == 4'000'000'255u);
+
+        static_assert(std::random_access_iterator<BitVector::iterator>);
+        static_assert(std::random_access_iterator<BitVector::const_iterator>);
+        static_assert(std::random_access_iterator<PackedIntVector<8>::iterator>);
+        static_assert(std::random_access_iterator<PackedIntVector<8>::const_iterator>);
+        const PackedIntVector<8> sorted{10u, 20u, 30u, 40u};
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), 25u);
+        assert(it - sorted.begin() == 2 && it[-1] == 20u && *it-- == 30u && it > sorted.begin());
+        assert(*(sorted.end() - 1) == 40u && it + 2 == 3 + sorted.begin());
+
+        auto scaled = PackedIntVector<40>::WithBase(1ull << 50);
+        scaled.PushBack((1ull << 50) + (1ull << 39));
+        scaled.Resize(70, (1ull << 50) + 5);
+        Vector<uint64_t> wide(70);
+        scaled.Decode(0, 70, wide.begin());
+        assert(wide[0] == (1ull << 50) + (1ull << 39) && wide[69] == (1ull << 50) + 5);
+        uint64_t sum = 0;
+        for (uint64_t value : std::as_const(scaled)) {
+            sum += value - scaled.Base();
+        }
+        assert(sum == (1ull << 39) + 69 * 5);
+    }
+}
+
+void Test28() {
+    using CachedVector = Vector<uint64_t, CachingAllocator<uint64_t>>;
+    BufferCache& cache = BufferCache::Local();
+    cache.Trim();
+    cache.ResetStats();
+    {
+        // Вместимость округляется до блока: 100 * 8 байт -> 1024 байта
+        CachedVector v;
+        v.Reserve(100);
+        assert(v.Capacity() == 128);
+    }
+    const BufferCacheStats& stats = cache.Stats();
+    assert(stats.misses == 1 && stats.hits == 0 && stats.recycled == 1 && stats.cached_bytes == 1024);
+    {
+        // Следующий вектор того же класса получает тот же буфер
+        CachedVector v(120);
+        assert(stats.hits == 1 && stats.cached_bytes == 0);
+        v.Resize(10);
+    }
+    // Рост удвоением проходит все классы до 1024 байт; повторный цикл обходится без operator new
+    for (int round = 0; round < 2; ++round) {
+        CachedVector v;
+        for (uint64_t i = 0; i < 128; ++i) {
+            v.PushBack(i);
+        }
+        assert(v[127] == 127);
+    }
+    assert(stats.misses == 7 && stats.hits == 9 && stats.HitRate() > 0.5);
+    assert(stats.cached_bytes == 16 + 32 + 64 + 128 + 256 + 512 + 1024);
+
+    // Лимиты и Trim
+    cache.SetBucketLimit(1000, 0);
+    assert(cache.BucketLimit(1024) == 0 && stats.cached_bytes == 1024 - 16);
+    {
+        CachedVector v(128);
+    }
+    assert(stats.released == 1 && stats.cached_bytes == 1024 - 16);
+    cache.Trim(100);
+    assert(stats.cached_bytes == 16 + 32);
+    cache.SetBucketLimits(BufferCache::kMinBucketLimit);
+    cache.Trim();
+    assert(stats.cached_bytes == 0);
+
+    // Большие блоки не кешируются; у другого потока свой кеш
+    {
+        CachedVector big(BufferCache::kMaxBlockBytes);
+        assert(big.Capacity() == BufferCache::kMaxBlockBytes);
+    }
+    assert(stats.cached_bytes == 0 && stats.released == 2);
+    std::thread([] {
+        {
+            Vector<std::string, CachingAllocator<std::string>> names{"a", "b"};
+            names.PushBack("c");
+        }
+        assert(BufferCache::Local().Stats().misses == 2 && BufferCache::Local().Stats().recycled == 2);
+    }).join();
+    assert(stats.misses == 9);
+    cache.ResetStats();
+    assert(stats.misses == 0 && stats.HitRate() == 0);
+}
+
+void Test29() {
+    Vector<float> b{1, 2, 3, 4, 5};
+    Vector<float> c{2, 2, 2, 2, 2};
+    Vector<float> d{0.5f, 0.5f, 0.5f, 0.5f, 0.5f};
+    {
+        // Вычисление в новый вектор и в вектор с достаточной вместимостью
+        Vector<float> a = b * c + d;
+        assert(a.Size() == 5 && a[0] == 2.5f && a[4] == 10.5f);
+        a.Reserve(100);
+        const float* buffer = a.begin();
+        a = (b - 1) / c - d;
+        assert(a.begin() == buffer && a.Capacity() == 100 && a[0] == -0.5f && a[4] == 1.5f);
+        a = -b;
+        assert(a[2] == -3.0f);
+    }
+    {
+        // Результат совпадает с операндом
+        Vector<float> a = b;
+        a = a * 2 + b;
+        assert(a.Size() == 5 && a[1] == 6.0f && a[4] == 15.0f);
+        a = a - a * a;
+        assert(a[0] == -6.0f);
+    }
+    {
+        Vector<float> a;
+        a = Fma(b, c, d);
+        assert(a[3] == 8.5f);
+        // ReLU на месте и маска сравнения в вектор целых
+        Vector<float> x{-2, -0.5f, 0, 0.5f, 2};
+        x = Select(Greater(x, 0.0f), x, 0.0f);
+        assert(x[0] == 0.0f && x[1] == 0.0f && x[3] == 0.5f && x[4] == 2.0f);
+        Vector<int> mask;
+        mask = LessEqual(b, 3);
+        assert(mask.Size() == 5 && mask[2] == 1 && mask[3] == 0);
+        mask = Equal(b, c) + NotEqual(b, c) * 2;
+        assert(mask[1] == 1 && mask[0] == 2);
+        Vector<double> mixed;
+        mixed = Select(GreaterEqual(b, 2), b * 0.5, Less(b, 0) - 1);
+        assert(mixed[0] == -1.0 && mixed[1] == 1.0);
+        // Укорочение переиспользует буфер
+        Vector<float> shorter{1, 2};
+        mixed = shorter * shorter;
+        assert(mixed.Size() == 2 && mixed[1] == 4.0);
+    }
+}
+
 int main() {
     try {
         Test1();
@@ -387,6 +2527,30 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,314 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Заголовок файла MappedVector. Данные начинаются с data_offset, выровненного по alignment;
+// вместимость определяется размером файла
+struct MappedVectorHeader {
+    static constexpr uint64_t kMagic = 0x3154434556504d4d;  // "MMPVECT1"
+    static constexpr uint32_t kVersion = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint32_t alignment;
+    uint32_t data_offset;
+    uint64_t count;
+};
+
+enum class MapMode {
+    kReadWrite,
+    kReadOnly,
+};
+
+// Вектор тривиально копируемых элементов, хранящий их в отображённом в память файле.
+// Открытие уже заполненного файла стоит O(1): элементы не разбираются и не копируются,
+// страницы подгружаются ядром по мере обращения.
+//
+//     MappedVector<Entry> table("entries.bin");  // создаёт файл или открывает существующий
+//     table.PushBack(entry);
+//     table.Flush();                             // msync: данные и размер на диске
+//
+//     MappedVector<Entry> snapshot("entries.bin", MapMode::kReadOnly);
+//
+// Рост буфера увеличивает файл через ftruncate и переотображает его (mremap на Linux).
+// Файл, записанный с другим sizeof(T), alignof(T) или версией формата, не открывается:
+// конструктор бросает std::runtime_error. Ошибки системных вызовов — std::system_error.
+//
+// В режиме kReadOnly файл отображён с PROT_READ: Reserve, Resize, PushBack, EmplaceBack
+// и PopBack бросают std::logic_error. Неконстантные operator[] и begin() по-прежнему
+// отдают T& и T*, но запись через них допустима только в режиме kReadWrite — в kReadOnly
+// она приводит к SIGSEGV. Снимок для чтения удобно держать как const MappedVector.
+template <typename T>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector requires a trivially copyable element type");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t kDataOffset =
+        (sizeof(MappedVectorHeader) + std::max(alignof(T), kCacheLineSize) - 1)
+        / std::max(alignof(T), kCacheLineSize) * std::max(alignof(T), kCacheLineSize);
+
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::kReadWrite)
+        : mode_(mode) {
+        const bool writable = mode == MapMode::kReadWrite;
+        fd_ = open(path.c_str(), writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open " + path);
+        }
+        try {
+            struct stat st {};
+            if (fstat(fd_, &st) != 0) {
+                ThrowSystemError("fstat " + path);
+            }
+            if (st.st_size == 0 && writable) {
+                Truncate(kDataOffset);
+                Map(kDataOffset);
+                *Header() = MappedVectorHeader{MappedVectorHeader::kMagic, MappedVectorHeader::kVersion, sizeof(T),
+                                               alignof(T), static_cast<uint32_t>(kDataOffset), 0};
+            } else {
+                if (static_cast<size_t>(st.st_size) < kDataOffset) {
+                    throw std::runtime_error(path + ": file is too small for a MappedVector header");
+                }
+                Map(static_cast<size_t>(st.st_size));
+                Validate(path);
+            }
+        } catch (...) {
+            Unmap();
+            close(fd_);
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , mode_(other.mode_)
+        , mapping_(std::exchange(other.mapping_, nullptr))
+        , mapped_bytes_(std::exchange(other.mapped_bytes_, 0)) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            mode_ = rhs.mode_;
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            mapped_bytes_ = std::exchange(rhs.mapped_bytes_, 0);
+        }
+        return *this;
+    }
+
+    // Файл остаётся на диске; несброшенные изменения ядро запишет само, но без гарантии
+    // момента — для неё нужен Flush()
+    ~MappedVector() {
+        Close();
+    }
+
+    bool IsReadOnly() const noexcept {
+        return mode_ == MapMode::kReadOnly;
+    }
+
+    size_t Size() const noexcept {
+        return mapping_ == nullptr ? 0 : Header()->count;
+    }
+
+    size_t Capacity() const noexcept {
+        return mapped_bytes_ < kDataOffset ? 0 : (mapped_bytes_ - kDataOffset) / sizeof(T);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Увеличивает файл до capacity элементов и переотображает его. Файл растёт целыми
+    // страницами, остаток последней страницы становится дополнительной вместимостью
+    void Reserve(size_t capacity) {
+        CheckWritable("Reserve");
+        if (capacity <= Capacity()) {
+            return;
+        }
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t bytes = (kDataOffset + capacity * sizeof(T) + page_size - 1) / page_size * page_size;
+        Truncate(bytes);
+        Remap(bytes);
+    }
+
+    void Resize(size_t new_size) {
+        CheckWritable("Resize");
+        const size_t size = Size();
+        if (new_size > Capacity()) {
+            Reserve(new_size);
+        }
+        for (size_t i = size; i < new_size; ++i) {
+            new (Data() + i) T();
+        }
+        Header()->count = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        CheckWritable("EmplaceBack");
+        const size_t size = Size();
+        if (size == Capacity()) {
+            // Аргументы могут ссылаться на элементы, а переотображение их сдвигает
+            T value(std::forward<Args>(args)...);
+            Reserve(DoublingGrowth::NextCapacity(Capacity(), sizeof(T)));
+            new (Data() + size) T(value);
+        } else {
+            new (Data() + size) T(std::forward<Args>(args)...);
+        }
+        Header()->count = size + 1;
+        return Data()[size];
+    }
+
+    void PopBack() {
+        CheckWritable("PopBack");
+        assert(Size() != 0);
+        --Header()->count;
+    }
+
+    // Синхронно записывает заголовок и элементы на диск
+    void Flush() {
+        if (mapping_ != nullptr && !IsReadOnly() && msync(mapping_, mapped_bytes_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+private:
+    MappedVectorHeader* Header() noexcept {
+        return static_cast<MappedVectorHeader*>(mapping_);
+    }
+
+    const MappedVectorHeader* Header() const noexcept {
+        return static_cast<const MappedVectorHeader*>(mapping_);
+    }
+
+    T* Data() noexcept {
+        return mapping_ == nullptr ? nullptr : reinterpret_cast<T*>(static_cast<char*>(mapping_) + kDataOffset);
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<MappedVector&>(*this).Data();
+    }
+
+    void Validate(const std::string& path) const {
+        const MappedVectorHeader& header = *Header();
+        if (header.magic != MappedVectorHeader::kMagic) {
+            throw std::runtime_error(path + ": not a MappedVector file");
+        }
+        if (header.version != MappedVectorHeader::kVersion) {
+            throw std::runtime_error(path + ": unsupported MappedVector version " + std::to_string(header.version));
+        }
+        if (header.element_size != sizeof(T) || header.alignment != alignof(T) || header.data_offset != kDataOffset) {
+            throw std::runtime_error(path + ": element layout does not match the file");
+        }
+        if (header.count > Capacity()) {
+            throw std::runtime_error(path + ": element count exceeds the file size");
+        }
+    }
+
+    void Map(size_t bytes) {
+        const int protection = IsReadOnly() ? PROT_READ : PROT_READ | PROT_WRITE;
+        void* p = mmap(nullptr, bytes, protection, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        mapping_ = p;
+        mapped_bytes_ = bytes;
+    }
+
+    void Remap(size_t bytes) {
+#if defined(__linux__)
+        void* p = mremap(mapping_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+        mapping_ = p;
+        mapped_bytes_ = bytes;
+#else
+        void* old_mapping = mapping_;
+        const size_t old_bytes = mapped_bytes_;
+        Map(bytes);
+        munmap(old_mapping, old_bytes);
+#endif
+    }
+
+    void Truncate(size_t bytes) {
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+    }
+
+    void Unmap() noexcept {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, mapped_bytes_);
+            mapping_ = nullptr;
+            mapped_bytes_ = 0;
+        }
+    }
+
+    void Close() noexcept {
+        Unmap();
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void CheckWritable(const char* operation) const {
+        if (IsReadOnly()) {
+            throw std::logic_error(std::string("MappedVector::") + operation + " on a read-only mapping");
+        }
+    }
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    int fd_ = -1;
+    MapMode mode_ = MapMode::kReadWrite;
+    void* mapping_ = nullptr;
+    size_t mapped_bytes_ = 0;
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include "allocators.h"
+
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Аллокатор для очень больших буферов: блоки от ThresholdBytes берутся анонимным mmap,
+// меньшие — через malloc. Рост большого буфера выполняется mremap: страницы
+// переотображаются без копирования, и пиковое потребление памяти не удваивается.
+// При UseHugePages большие блоки помечаются MADV_HUGEPAGE (transparent huge pages),
+// что уменьшает число промахов TLB.
+//
+// Вектор пользуется reallocate только для тривиально перемещаемых элементов,
+// остальные переезжают обычным образом.
+template <typename T, size_t ThresholdBytes = 1 << 20, bool UseHugePages = false>
+class MmapAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "MmapAllocator cannot satisfy alignment of T");
+
+    template <typename U>
+    struct rebind {
+        using other = MmapAllocator<U, ThresholdBytes, UseHugePages>;
+    };
+
+    MmapAllocator() = default;
+
+    template <typename U>
+    MmapAllocator(const MmapAllocator<U, ThresholdBytes, UseHugePages>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    // Большой блок занимает целое число страниц; весь хвост последней страницы
+    // отдаётся под элементы
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const size_t bytes = BytesFor(n);
+        if (!IsLarge(bytes)) {
+            return {MallocAllocator<T>().allocate(n), n};
+        }
+        const size_t mapped = RoundToPages(bytes);
+        void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        AdviseHugePages(p, mapped);
+        return {static_cast<T*>(p), mapped / sizeof(T)};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsLarge(bytes)) {
+            munmap(p, RoundToPages(bytes));
+        } else {
+            MallocAllocator<T>().deallocate(p, n);
+        }
+    }
+
+    // Вместимость считается так же, как в allocate_at_least: большой блок — все его страницы,
+    // малый — ровно new_n, чтобы deallocate по вместимости не принял блок malloc за большой
+    AllocationResult<T*> reallocate(T* p, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = BytesFor(new_n);
+        const bool was_large = p != nullptr && IsLarge(old_bytes);
+
+        if (!was_large && !IsLarge(new_bytes)) {
+            return {MallocAllocator<T>().reallocate(p, old_n, new_n).ptr, new_n};
+        }
+        if (was_large && IsLarge(new_bytes)) {
+            const size_t mapped = RoundToPages(new_bytes);
+            void* result = mremap(p, RoundToPages(old_bytes), mapped, MREMAP_MAYMOVE);
+            if (result == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            AdviseHugePages(result, mapped);
+            return {static_cast<T*>(result), mapped / sizeof(T)};
+        }
+
+        // Переход между malloc и mmap: копируем содержимое, которое помещается в новый блок
+        const AllocationResult<T*> result = allocate_at_least(new_n);
+        if (p != nullptr) {
+            const size_t copy_bytes = old_bytes < new_bytes ? old_bytes : new_bytes;
+            std::memcpy(static_cast<void*>(result.ptr), static_cast<const void*>(p), copy_bytes);
+            deallocate(p, old_n);
+        }
+        return result;
+    }
+
+    template <typename U>
+    bool operator==(const MmapAllocator<U, ThresholdBytes, UseHugePages>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MmapAllocator<U, ThresholdBytes, UseHugePages>&) const noexcept {
+        return false;
+    }
+
+private:
+    static bool IsLarge(size_t bytes) noexcept {
+        return bytes >= ThresholdBytes;
+    }
+
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    static size_t RoundToPages(size_t bytes) noexcept {
+        const size_t page_size = PageSize();
+        return (bytes + page_size - 1) / page_size * page_size;
+    }
+
+    static size_t BytesFor(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static void AdviseHugePages([[maybe_unused]] void* p, [[maybe_unused]] size_t bytes) noexcept {
+#if defined(MADV_HUGEPAGE)
+        if constexpr (UseHugePages) {
+            // Подсказка необязательна: без поддержки THP ядро вернёт ошибку, и память останется обычной
+            madvise(p, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+};
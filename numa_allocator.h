@@ -0,0 +1,360 @@
+#pragma once
+#include "mmap_allocator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Размещение памяти больших векторов по узлам NUMA.
+//
+// NumaAllocator<T> выделяет большие блоки через MmapAllocator и задаёт им политику ядра
+// через mbind: привязку к узлу (Bind), чередование страниц по всем узлам (Interleave)
+// или размещение по первому касанию (FirstTouch): страница попадает на узел потока,
+// который первым в неё записал. Чтобы куски буфера легли на разные узлы, вектор создают
+// параллельно через NumaFirstTouchExecutor: он закрепляет поток, создающий кусок,
+// за узлом этого куска, и каждый узел получает свою непрерывную часть буфера:
+//
+//     ThreadPool pool;
+//     NumaFirstTouchExecutor placed(pool);
+//     Vector<double, NumaAllocator<double>> v(n, placed, NumaAllocator<double>(NumaPolicy::FirstTouch()));
+//
+// На машине с одним узлом, без поддержки NUMA в ядре или вне Linux политики ничего
+// не делают, и аллокатор ведёт себя как MmapAllocator.
+
+enum class NumaMode {
+    kFirstTouch,
+    kBind,
+    kInterleave,
+};
+
+struct NumaPolicy {
+    static NumaPolicy FirstTouch() noexcept {
+        return {NumaMode::kFirstTouch, -1};
+    }
+    static NumaPolicy Bind(int node) noexcept {
+        return {NumaMode::kBind, node};
+    }
+    static NumaPolicy Interleave() noexcept {
+        return {NumaMode::kInterleave, -1};
+    }
+
+    bool operator==(const NumaPolicy& other) const noexcept {
+        return mode == other.mode && node == other.node;
+    }
+    bool operator!=(const NumaPolicy& other) const noexcept {
+        return !(*this == other);
+    }
+
+    NumaMode mode = NumaMode::kFirstTouch;
+    int node = -1;
+};
+
+namespace numa_detail {
+
+// Значения из <numaif.h>, который есть не везде
+inline constexpr int kMpolDefault = 0;
+inline constexpr int kMpolPreferred = 1;
+inline constexpr int kMpolBind = 2;
+inline constexpr int kMpolInterleave = 3;
+inline constexpr int kMpolFNode = 1 << 0;
+inline constexpr int kMpolFAddr = 1 << 1;
+
+inline constexpr size_t kMaxNodes = 1024;
+inline constexpr size_t kMaskWords = kMaxNodes / (8 * sizeof(unsigned long));
+
+struct NodeMask {
+    void Set(int node) noexcept {
+        if (node >= 0 && static_cast<size_t>(node) < kMaxNodes) {
+            words[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        }
+    }
+
+    unsigned long words[kMaskWords] = {};
+};
+
+// Разбирает списки вида "0-3,8,10-11" из /sys/devices/system/node
+inline std::vector<int> ParseList(const std::string& text) {
+    std::vector<int> result;
+    std::stringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        int first = 0;
+        int last = 0;
+        const int parsed = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (parsed <= 0) {
+            continue;
+        }
+        if (parsed == 1) {
+            last = first;
+        }
+        for (int i = first; i <= last; ++i) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+inline std::vector<int> ReadList(const std::string& path) {
+    std::ifstream file(path);
+    std::string text;
+    std::getline(file, text);
+    return ParseList(text);
+}
+
+}  // namespace numa_detail
+
+// Узлы NUMA, на которых сейчас есть память; на машине без NUMA — {0}
+inline const std::vector<int>& NumaNodes() {
+    static const std::vector<int> nodes = [] {
+        std::vector<int> online;
+#if defined(__linux__)
+        online = numa_detail::ReadList("/sys/devices/system/node/has_memory");
+        if (online.empty()) {
+            online = numa_detail::ReadList("/sys/devices/system/node/online");
+        }
+#endif
+        if (online.empty()) {
+            online.push_back(0);
+        }
+        return online;
+    }();
+    return nodes;
+}
+
+inline bool IsNumaSystem() {
+    return NumaNodes().size() > 1;
+}
+
+// Задаёт политику policy диапазону [p, p + bytes), выровненному по странице.
+// Возвращает false, если политика не применена (один узел, нет поддержки в ядре)
+inline bool ApplyNumaPolicy([[maybe_unused]] void* p, [[maybe_unused]] size_t bytes,
+                            [[maybe_unused]] const NumaPolicy& policy) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (!IsNumaSystem()) {
+        return false;
+    }
+    numa_detail::NodeMask mask;
+    int mode = numa_detail::kMpolDefault;
+    switch (policy.mode) {
+    case NumaMode::kFirstTouch:
+        break;
+    case NumaMode::kBind:
+        mode = numa_detail::kMpolBind;
+        mask.Set(policy.node);
+        break;
+    case NumaMode::kInterleave:
+        mode = numa_detail::kMpolInterleave;
+        for (int node : NumaNodes()) {
+            mask.Set(node);
+        }
+        break;
+    }
+    const unsigned long* nodes = mode == numa_detail::kMpolDefault ? nullptr : mask.words;
+    return syscall(SYS_mbind, p, bytes, mode, nodes, numa_detail::kMaxNodes + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+// Узел, на котором лежит страница с адресом p (страница при этом создаётся), или -1
+inline int NumaNodeOf([[maybe_unused]] const void* p) noexcept {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, p, numa_detail::kMpolFNode | numa_detail::kMpolFAddr) != 0) {
+        return -1;
+    }
+    return node;
+#else
+    return -1;
+#endif
+}
+
+// Переносит вызывающий поток на процессоры узла node и просит ядро выделять его
+// новые страницы там же (set_mempolicy с MPOL_PREFERRED). Возвращает false,
+// если узел неизвестен или машина не NUMA
+inline bool BindThreadToNode([[maybe_unused]] int node) noexcept {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    if (!IsNumaSystem()) {
+        return false;
+    }
+    try {
+        const std::vector<int> cpus =
+            numa_detail::ReadList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (cpus.empty()) {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            return false;
+        }
+    } catch (...) {
+        return false;
+    }
+    numa_detail::NodeMask mask;
+    mask.Set(node);
+    return syscall(SYS_set_mempolicy, numa_detail::kMpolPreferred, mask.words, numa_detail::kMaxNodes + 1) == 0;
+#else
+    return false;
+#endif
+}
+
+// Закрепляет вызывающий поток за узлом node на время своей жизни, как BindThreadToNode,
+// а в деструкторе возвращает потоку прежние процессоры и политику памяти
+class ScopedNodeBinding {
+public:
+    explicit ScopedNodeBinding([[maybe_unused]] int node) noexcept {
+#if defined(__linux__) && defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+        if (!IsNumaSystem()) {
+            return;
+        }
+        CPU_ZERO(&affinity_);
+        saved_affinity_ = sched_getaffinity(0, sizeof(affinity_), &affinity_) == 0;
+        saved_policy_ = syscall(SYS_get_mempolicy, &mode_, mask_.words, numa_detail::kMaxNodes + 1, nullptr, 0) == 0;
+        BindThreadToNode(node);
+#endif
+    }
+
+    ScopedNodeBinding(const ScopedNodeBinding&) = delete;
+    ScopedNodeBinding& operator=(const ScopedNodeBinding&) = delete;
+
+    ~ScopedNodeBinding() {
+#if defined(__linux__) && defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+        if (saved_policy_) {
+            syscall(SYS_set_mempolicy, mode_, mask_.words, numa_detail::kMaxNodes + 1);
+        }
+        if (saved_affinity_) {
+            sched_setaffinity(0, sizeof(affinity_), &affinity_);
+        }
+#endif
+    }
+
+private:
+#if defined(__linux__) && defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+    cpu_set_t affinity_;
+    int mode_ = numa_detail::kMpolDefault;
+    numa_detail::NodeMask mask_;
+    bool saved_affinity_ = false;
+    bool saved_policy_ = false;
+#endif
+};
+
+// Исполнитель параллельных операций Vector для размещения первым касанием. Передаёт
+// работу executor (например, ThreadPool), но каждый кусок выполняет поток, на это время
+// закреплённый за узлом куска: куски делятся между NumaNodes() подряд идущими равными
+// группами, так что первая часть буфера ложится на первый узел, следующая — на второй.
+// Вместе с NumaPolicy::FirstTouch это даёт размещение кусков по узлам (с точностью до
+// страницы на их границах); обрабатывать вектор потом выгодно тем же разбиением.
+// Потоки executor после каждого куска возвращаются к прежним процессорам и политике
+template <typename Executor>
+class NumaFirstTouchExecutor {
+public:
+    explicit NumaFirstTouchExecutor(Executor& executor) noexcept
+        : executor_(executor) {
+    }
+
+    // Не меньше числа узлов, чтобы каждому узлу достался хотя бы один кусок
+    size_t Concurrency() const noexcept {
+        return std::max(executor_.Concurrency(), NumaNodes().size());
+    }
+
+    // Узел куска chunk из count
+    static int NodeOfChunk(size_t chunk, size_t count) {
+        const std::vector<int>& nodes = NumaNodes();
+        return nodes[chunk * nodes.size() / count];
+    }
+
+    template <typename Fn>
+    void ParallelFor(size_t count, Fn&& fn) {
+        executor_.ParallelFor(count, [&fn, count](size_t chunk) {
+            ScopedNodeBinding binding(NodeOfChunk(chunk, count));
+            fn(chunk);
+        });
+    }
+
+private:
+    Executor& executor_;
+};
+
+// Аллокатор с политикой размещения NUMA для блоков от ThresholdBytes; меньшие блоки
+// выделяются через malloc, их размещение не важно. Аллокаторы с разными политиками
+// не равны, поэтому вектор не заберёт чужой буфер при перемещении
+template <typename T, size_t ThresholdBytes = 1 << 20>
+class NumaAllocator {
+    using Base = MmapAllocator<T, ThresholdBytes>;
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = NumaAllocator<U, ThresholdBytes>;
+    };
+
+    NumaAllocator() = default;
+
+    explicit NumaAllocator(NumaPolicy policy) noexcept
+        : policy_(policy) {
+    }
+
+    template <typename U>
+    NumaAllocator(const NumaAllocator<U, ThresholdBytes>& other) noexcept
+        : policy_(other.GetPolicy()) {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const AllocationResult<T*> result = Base().allocate_at_least(n);
+        Place(result.ptr, result.count);
+        return result;
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        Base().deallocate(p, n);
+    }
+
+    // mremap сохраняет политику перенесённых страниц; она задаётся заново для всего блока,
+    // чтобы покрыть и добавленные страницы
+    AllocationResult<T*> reallocate(T* p, size_t old_n, size_t new_n) {
+        const AllocationResult<T*> result = Base().reallocate(p, old_n, new_n);
+        Place(result.ptr, result.count);
+        return result;
+    }
+
+    NumaPolicy GetPolicy() const noexcept {
+        return policy_;
+    }
+
+    template <typename U>
+    bool operator==(const NumaAllocator<U, ThresholdBytes>& other) const noexcept {
+        return policy_ == other.GetPolicy();
+    }
+
+    template <typename U>
+    bool operator!=(const NumaAllocator<U, ThresholdBytes>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    void Place(T* p, size_t n) const noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (bytes >= ThresholdBytes) {
+            const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            ApplyNumaPolicy(p, (bytes + page_size - 1) / page_size * page_size, policy_);
+        }
+    }
+
+    NumaPolicy policy_;
+};
@@ -0,0 +1,805 @@
+#pragma once
+#include "vector.h"
+#include "vector_algorithms.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Векторы упакованных значений на RawMemory<uint64_t>: BitVector хранит бит на флаг,
+// PackedIntVector<Bits> — Bits бит на целое. Элементы не адресуемы по отдельности,
+// поэтому operator[] и итераторы неконстантного вектора возвращают прокси-ссылки,
+// как std::vector<bool>, а константного — значения.
+
+namespace packed_detail {
+
+inline constexpr size_t kWordBits = 64;
+
+constexpr size_t WordsFor(size_t bits) noexcept {
+    return (bits + kWordBits - 1) / kWordBits;
+}
+
+// Маска младших count бит, count от 0 до 64
+constexpr uint64_t LowMask(size_t count) noexcept {
+    return count == kWordBits ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+}
+
+// Позиция k-го (с нуля) установленного бита слова; бит должен существовать
+inline size_t SelectInWord(uint64_t word, size_t k) noexcept {
+    for (; k > 0; --k) {
+        word &= word - 1;
+    }
+    return static_cast<size_t>(std::countr_zero(word));
+}
+
+// Слова, которые всегда инициализированы: при выделении буфер целиком заполняется нулями,
+// поэтому запись по маске не читает неинициализированную память. Владельцы держат нулями
+// и биты за концом вектора
+class WordBuffer {
+public:
+    WordBuffer() = default;
+
+    explicit WordBuffer(size_t words)
+        : words_(words) {
+        std::fill_n(words_.GetAddress(), words_.Capacity(), uint64_t{0});
+    }
+
+    // Копирует первые used слов; остальные нулевые
+    WordBuffer(const WordBuffer& other, size_t used)
+        : WordBuffer(used) {
+        std::copy_n(other.Data(), used, Data());
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity();
+    }
+
+    uint64_t* Data() noexcept {
+        return words_.GetAddress();
+    }
+
+    const uint64_t* Data() const noexcept {
+        return words_.GetAddress();
+    }
+
+    uint64_t& operator[](size_t index) noexcept {
+        return words_[index];
+    }
+
+    const uint64_t& operator[](size_t index) const noexcept {
+        return words_[index];
+    }
+
+    // Расширяет буфер до words слов, сохраняя первые used
+    void Grow(size_t words, size_t used) {
+        WordBuffer grown(words);
+        std::copy_n(Data(), used, grown.Data());
+        Swap(grown);
+    }
+
+    void Swap(WordBuffer& other) noexcept {
+        words_.Swap(other.words_);
+    }
+
+private:
+    RawMemory<uint64_t> words_;
+};
+
+// Итератор по индексу: разыменование возвращает то же, что (*owner)[index]
+template <typename Owner, typename Reference, typename Value>
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using reference = Reference;
+    using pointer = void;
+
+    IndexIterator() = default;
+    IndexIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return (*owner_)[index_ + offset];
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    IndexIterator operator++(int) noexcept {
+        return IndexIterator(owner_, index_++);
+    }
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    IndexIterator operator--(int) noexcept {
+        return IndexIterator(owner_, index_--);
+    }
+    IndexIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+    IndexIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+    IndexIterator operator+(difference_type offset) const noexcept {
+        return IndexIterator(owner_, index_ + offset);
+    }
+    friend IndexIterator operator+(difference_type offset, const IndexIterator& it) noexcept {
+        return it + offset;
+    }
+    IndexIterator operator-(difference_type offset) const noexcept {
+        return IndexIterator(owner_, index_ - offset);
+    }
+    difference_type operator-(const IndexIterator& other) const noexcept {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+
+    bool operator==(const IndexIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const IndexIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+    bool operator<(const IndexIterator& other) const noexcept {
+        return index_ < other.index_;
+    }
+    bool operator>(const IndexIterator& other) const noexcept {
+        return index_ > other.index_;
+    }
+    bool operator<=(const IndexIterator& other) const noexcept {
+        return index_ <= other.index_;
+    }
+    bool operator>=(const IndexIterator& other) const noexcept {
+        return index_ >= other.index_;
+    }
+
+private:
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
+
+namespace packed_scalar {
+#include "packed_vector_kernels.inc"
+}  // namespace packed_scalar
+
+#if defined(VECTOR_ALGORITHMS_X86)
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+namespace packed_avx2 {
+#include "packed_vector_kernels.inc"
+}  // namespace packed_avx2
+#pragma GCC pop_options
+#endif
+
+inline size_t PopCount(const uint64_t* words, size_t n) {
+#if defined(VECTOR_ALGORITHMS_X86)
+    if (DetectSimdLevel() >= SimdLevel::kAvx2) {
+        return packed_avx2::PopCount(words, n);
+    }
+#endif
+    return packed_scalar::PopCount(words, n);
+}
+
+template <size_t Bits, typename Value>
+void DecodeBlocks(const uint64_t* words, size_t blocks, Value base, Value* out) {
+#if defined(VECTOR_ALGORITHMS_X86)
+    if (DetectSimdLevel() >= SimdLevel::kAvx2) {
+        packed_avx2::DecodeBlocks<Bits>(words, blocks, base, out);
+        return;
+    }
+#endif
+    packed_scalar::DecodeBlocks<Bits>(words, blocks, base, out);
+}
+
+}  // namespace packed_detail
+
+// Вектор битов: в 8 раз компактнее Vector<bool>. Count, Rank и Select считают биты
+// словами по 64 с popcnt, побитовые &=, |=, ^= и Flip() тоже работают пословно.
+// Rank и Select без индекса просматривают слова от начала; BuildRankIndex() строит
+// накопленные счётчики по блокам из 512 бит (1/8 памяти вектора), после чего Rank
+// стоит O(1), а Select — O(log n). Любое изменение вектора сбрасывает индекс.
+class BitVector {
+    static constexpr size_t kBlockWords = 8;
+
+public:
+    class Reference {
+    public:
+        Reference(BitVector* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        operator bool() const noexcept {
+            return owner_->Test(index_);
+        }
+
+        Reference& operator=(bool value) noexcept {
+            owner_->Set(index_, value);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) noexcept {
+            return *this = static_cast<bool>(other);
+        }
+
+        void Flip() noexcept {
+            owner_->Flip(index_);
+        }
+
+    private:
+        BitVector* owner_;
+        size_t index_;
+    };
+
+    using iterator = packed_detail::IndexIterator<BitVector, Reference, bool>;
+    using const_iterator = packed_detail::IndexIterator<const BitVector, bool, bool>;
+
+    BitVector() = default;
+
+    explicit BitVector(size_t size, bool value = false) {
+        Resize(size, value);
+    }
+
+    BitVector(std::initializer_list<bool> init) {
+        Reserve(init.size());
+        for (bool value : init) {
+            PushBack(value);
+        }
+    }
+
+    BitVector(const BitVector& other)
+        : words_(other.words_, packed_detail::WordsFor(other.size_))
+        , size_(other.size_) {
+    }
+
+    BitVector(BitVector&& other) noexcept {
+        Swap(other);
+    }
+
+    BitVector& operator=(const BitVector& rhs) {
+        if (this != &rhs) {
+            BitVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    BitVector& operator=(BitVector&& rhs) noexcept {
+        if (this != &rhs) {
+            BitVector rhs_temp(std::move(rhs));
+            Swap(rhs_temp);
+        }
+        return *this;
+    }
+
+    void Swap(BitVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+        rank_blocks_.Swap(other.rank_blocks_);
+        std::swap(rank_valid_, other.rank_valid_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * packed_detail::kWordBits;
+    }
+
+    // Слова вектора; биты за Size() в последнем слове нулевые
+    std::span<const uint64_t> Words() const noexcept {
+        return {words_.Data(), packed_detail::WordsFor(size_)};
+    }
+
+    bool Test(size_t index) const noexcept {
+        assert(index < size_);
+        return (words_[index / 64] >> (index % 64)) & 1;
+    }
+
+    void Set(size_t index, bool value = true) noexcept {
+        assert(index < size_);
+        const uint64_t bit = uint64_t{1} << (index % 64);
+        uint64_t& word = words_[index / 64];
+        word = value ? word | bit : word & ~bit;
+        rank_valid_ = false;
+    }
+
+    void Flip(size_t index) noexcept {
+        assert(index < size_);
+        words_[index / 64] ^= uint64_t{1} << (index % 64);
+        rank_valid_ = false;
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return {this, index};
+    }
+
+    bool operator[](size_t index) const noexcept {
+        return Test(index);
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+
+    void Reserve(size_t capacity) {
+        if (capacity > Capacity()) {
+            words_.Grow(packed_detail::WordsFor(capacity), packed_detail::WordsFor(size_));
+        }
+    }
+
+    void Resize(size_t new_size, bool value = false) {
+        Reserve(new_size);
+        if (new_size > size_) {
+            FillRange(size_, new_size, value);
+        } else {
+            FillRange(new_size, size_, false);
+        }
+        size_ = new_size;
+        rank_valid_ = false;
+    }
+
+    void PushBack(bool value) {
+        if (size_ == Capacity()) {
+            words_.Grow(std::max<size_t>(1, words_.Capacity() * 2), packed_detail::WordsFor(size_));
+        }
+        ++size_;
+        Set(size_ - 1, value);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        Set(size_ - 1, false);
+        --size_;
+    }
+
+    void Clear() noexcept {
+        std::fill_n(words_.Data(), packed_detail::WordsFor(size_), uint64_t{0});
+        size_ = 0;
+        rank_valid_ = false;
+    }
+
+    // Число установленных битов
+    size_t Count() const noexcept {
+        return packed_detail::PopCount(words_.Data(), packed_detail::WordsFor(size_));
+    }
+
+    // Число установленных битов в [0, index)
+    size_t Rank(size_t index) const noexcept {
+        assert(index <= size_);
+        const size_t word = index / 64;
+        size_t first_word = 0;
+        size_t count = 0;
+        if (rank_valid_) {
+            first_word = word / kBlockWords * kBlockWords;
+            count = rank_blocks_[word / kBlockWords];
+        }
+        count += packed_detail::PopCount(words_.Data() + first_word, word - first_word);
+        if (index % 64 != 0) {
+            count += static_cast<size_t>(std::popcount(words_[word] & packed_detail::LowMask(index % 64)));
+        }
+        return count;
+    }
+
+    // Позиция установленного бита с номером k (с нуля) или Size(), если битов не больше k
+    size_t Select(size_t k) const noexcept {
+        const size_t words = packed_detail::WordsFor(size_);
+        size_t word = 0;
+        if (rank_valid_) {
+            // Последний блок, перед которым установлено не больше k битов
+            const size_t block = static_cast<size_t>(
+                std::upper_bound(rank_blocks_.begin(), rank_blocks_.end(), k) - rank_blocks_.begin() - 1);
+            word = block * kBlockWords;
+            k -= rank_blocks_[block];
+        }
+        for (; word < words; ++word) {
+            const size_t ones = static_cast<size_t>(std::popcount(words_[word]));
+            if (k < ones) {
+                return word * 64 + packed_detail::SelectInWord(words_[word], k);
+            }
+            k -= ones;
+        }
+        return size_;
+    }
+
+    // Позиция первого установленного бита, не меньшая from, или Size()
+    size_t FindNext(size_t from) const noexcept {
+        if (from >= size_) {
+            return size_;
+        }
+        const size_t words = packed_detail::WordsFor(size_);
+        size_t word = from / 64;
+        uint64_t bits = words_[word] & ~packed_detail::LowMask(from % 64);
+        while (bits == 0) {
+            if (++word == words) {
+                return size_;
+            }
+            bits = words_[word];
+        }
+        return word * 64 + static_cast<size_t>(std::countr_zero(bits));
+    }
+
+    void BuildRankIndex() {
+        const size_t words = packed_detail::WordsFor(size_);
+        Vector<size_t> blocks;
+        blocks.Reserve(words / kBlockWords + 2);
+        size_t count = 0;
+        for (size_t word = 0; word < words; word += kBlockWords) {
+            blocks.PushBack(count);
+            count += packed_detail::PopCount(words_.Data() + word, std::min(kBlockWords, words - word));
+        }
+        // Итог всего вектора: нужен Rank(Size()), когда число слов кратно размеру блока
+        blocks.PushBack(count);
+        rank_blocks_.Swap(blocks);
+        rank_valid_ = true;
+    }
+
+    // Побитовые операции с вектором того же размера
+    BitVector& operator&=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t a, uint64_t b) {
+            return a & b;
+        });
+    }
+
+    BitVector& operator|=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t a, uint64_t b) {
+            return a | b;
+        });
+    }
+
+    BitVector& operator^=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t a, uint64_t b) {
+            return a ^ b;
+        });
+    }
+
+    // Инвертирует все биты
+    void Flip() noexcept {
+        const size_t words = packed_detail::WordsFor(size_);
+        for (size_t i = 0; i < words; ++i) {
+            words_[i] = ~words_[i];
+        }
+        if (size_ % 64 != 0) {
+            words_[words - 1] &= packed_detail::LowMask(size_ % 64);
+        }
+        rank_valid_ = false;
+    }
+
+    bool operator==(const BitVector& other) const noexcept {
+        return size_ == other.size_
+            && std::equal(words_.Data(), words_.Data() + packed_detail::WordsFor(size_), other.words_.Data());
+    }
+
+private:
+    // Записывает value в биты [first, last): неполные слова по маске, остальные целиком
+    void FillRange(size_t first, size_t last, bool value) noexcept {
+        if (first == last) {
+            return;
+        }
+        const uint64_t fill = value ? ~uint64_t{0} : 0;
+        const size_t first_word = first / 64;
+        const size_t last_word = (last - 1) / 64;
+        for (size_t word = first_word; word <= last_word; ++word) {
+            uint64_t mask = ~uint64_t{0};
+            if (word == first_word) {
+                mask &= ~packed_detail::LowMask(first % 64);
+            }
+            if (word == last_word) {
+                mask &= packed_detail::LowMask(last - last_word * 64);
+            }
+            words_[word] = (words_[word] & ~mask) | (fill & mask);
+        }
+    }
+
+    template <typename Op>
+    BitVector& Combine(const BitVector& rhs, Op op) noexcept {
+        assert(size_ == rhs.size_);
+        const size_t words = packed_detail::WordsFor(size_);
+        uint64_t* dst = words_.Data();
+        const uint64_t* src = rhs.words_.Data();
+        for (size_t i = 0; i < words; ++i) {
+            dst[i] = op(dst[i], src[i]);
+        }
+        rank_valid_ = false;
+        return *this;
+    }
+
+    packed_detail::WordBuffer words_;
+    size_t size_ = 0;
+    // Число установленных битов перед каждым блоком из kBlockWords слов
+    Vector<size_t> rank_blocks_;
+    bool rank_valid_ = false;
+};
+
+// Вектор целых по Bits бит на значение со сдвигом (frame of reference): хранится
+// value - Base(), так что столбец идентификаторов из узкого диапазона [base, base + 2^Bits)
+// занимает Bits бит на элемент независимо от величины самих значений. Конструктор из
+// диапазона берёт за Base() минимум. Значения вне диапазона вызывают std::out_of_range.
+//
+// operator[] и Get читают значение за O(1) (одно или два слова). Decode распаковывает
+// подряд идущие значения блоками по 64 — это путь для сканирования столбца; на AVX2
+// распаковка векторизуется.
+template <size_t Bits>
+class PackedIntVector {
+    static_assert(Bits > 0 && Bits <= 64, "Bits must be in [1, 64]");
+
+public:
+    using Value = std::conditional_t<Bits <= 32, uint32_t, uint64_t>;
+
+    static constexpr uint64_t kMaxDelta = packed_detail::LowMask(Bits);
+
+    class Reference {
+    public:
+        Reference(PackedIntVector* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        operator Value() const noexcept {
+            return owner_->Get(index_);
+        }
+
+        Reference& operator=(Value value) {
+            owner_->Set(index_, value);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) {
+            return *this = static_cast<Value>(other);
+        }
+
+    private:
+        PackedIntVector* owner_;
+        size_t index_;
+    };
+
+    using iterator = packed_detail::IndexIterator<PackedIntVector, Reference, Value>;
+    using const_iterator = packed_detail::IndexIterator<const PackedIntVector, Value, Value>;
+
+    PackedIntVector() = default;
+
+    explicit PackedIntVector(size_t size) {
+        Resize(size);
+    }
+
+    // Пустой вектор для значений из [base, base + 2^Bits)
+    static PackedIntVector WithBase(Value base) {
+        PackedIntVector result;
+        result.base_ = base;
+        return result;
+    }
+
+    // База — минимум диапазона, поэтому диапазон читается дважды; однопроходный
+    // сначала копируется в Vector
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    PackedIntVector(InputIt first, InputIt last) {
+        if constexpr (kIsForwardIterator<InputIt>) {
+            AppendWithMinBase(first, last);
+        } else {
+            const Vector<Value> values(first, last);
+            AppendWithMinBase(values.begin(), values.end());
+        }
+    }
+
+    PackedIntVector(std::initializer_list<Value> init)
+        : PackedIntVector(init.begin(), init.end()) {
+    }
+
+    PackedIntVector(const PackedIntVector& other)
+        : words_(other.words_, packed_detail::WordsFor(other.size_ * Bits))
+        , size_(other.size_)
+        , base_(other.base_) {
+    }
+
+    PackedIntVector(PackedIntVector&& other) noexcept {
+        Swap(other);
+    }
+
+    PackedIntVector& operator=(const PackedIntVector& rhs) {
+        if (this != &rhs) {
+            PackedIntVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    PackedIntVector& operator=(PackedIntVector&& rhs) noexcept {
+        if (this != &rhs) {
+            PackedIntVector rhs_temp(std::move(rhs));
+            Swap(rhs_temp);
+        }
+        return *this;
+    }
+
+    void Swap(PackedIntVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+        std::swap(base_, other.base_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * packed_detail::kWordBits / Bits;
+    }
+
+    Value Base() const noexcept {
+        return base_;
+    }
+
+    Value Get(size_t index) const noexcept {
+        assert(index < size_);
+        const size_t bit = index * Bits;
+        const size_t word = bit / 64;
+        const size_t offset = bit % 64;
+        uint64_t delta = words_[word] >> offset;
+        if constexpr (64 % Bits != 0) {
+            if (offset + Bits > 64) {
+                delta |= words_[word + 1] << (64 - offset);
+            }
+        }
+        return static_cast<Value>(delta & kMaxDelta) + base_;
+    }
+
+    void Set(size_t index, Value value) {
+        assert(index < size_);
+        const uint64_t delta = Delta(value);
+        const size_t bit = index * Bits;
+        const size_t word = bit / 64;
+        const size_t offset = bit % 64;
+        words_[word] = (words_[word] & ~(kMaxDelta << offset)) | (delta << offset);
+        if constexpr (64 % Bits != 0) {
+            if (offset + Bits > 64) {
+                const size_t spilled = 64 - offset;
+                words_[word + 1] = (words_[word + 1] & ~(kMaxDelta >> spilled)) | (delta >> spilled);
+            }
+        }
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return {this, index};
+    }
+
+    Value operator[](size_t index) const noexcept {
+        return Get(index);
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+
+    void Reserve(size_t capacity) {
+        if (capacity > Capacity()) {
+            words_.Grow(packed_detail::WordsFor(capacity * Bits), packed_detail::WordsFor(size_ * Bits));
+        }
+    }
+
+    // Новые элементы равны value (по умолчанию Base())
+    void Resize(size_t new_size) {
+        Resize(new_size, base_);
+    }
+
+    void Resize(size_t new_size, Value value) {
+        const uint64_t delta = Delta(value);
+        Reserve(new_size);
+        if (new_size < size_) {
+            // Биты за концом остаются нулевыми
+            for (size_t i = new_size; i < size_; ++i) {
+                Set(i, base_);
+            }
+        } else if (delta != 0) {
+            for (size_t i = size_; i < new_size; ++i) {
+                size_ = i + 1;
+                Set(i, value);
+            }
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(Value value) {
+        Delta(value);
+        if (size_ == Capacity()) {
+            words_.Grow(std::max(packed_detail::WordsFor((size_ + 1) * Bits), words_.Capacity() * 2),
+                        packed_detail::WordsFor(size_ * Bits));
+        }
+        ++size_;
+        Set(size_ - 1, value);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        Set(size_ - 1, base_);
+        --size_;
+    }
+
+    void Clear() noexcept {
+        std::fill_n(words_.Data(), packed_detail::WordsFor(size_ * Bits), uint64_t{0});
+        size_ = 0;
+    }
+
+    // Распаковывает count значений, начиная с first, в out
+    void Decode(size_t first, size_t count, Value* out) const noexcept {
+        assert(first + count <= size_);
+        // Блоки по 64 значения начинаются с границы слова
+        size_t head = std::min(count, (64 - first % 64) % 64);
+        for (size_t i = 0; i < head; ++i) {
+            out[i] = Get(first + i);
+        }
+        const size_t blocks = (count - head) / 64;
+        packed_detail::DecodeBlocks<Bits>(words_.Data() + (first + head) / 64 * Bits, blocks, base_, out + head);
+        for (size_t i = head + blocks * 64; i < count; ++i) {
+            out[i] = Get(first + i);
+        }
+    }
+
+    Vector<Value> Decode() const {
+        Vector<Value> result;
+        result.ResizeDefaultInit(size_);
+        Decode(0, size_, result.begin());
+        return result;
+    }
+
+private:
+    template <typename ForwardIt>
+    void AppendWithMinBase(ForwardIt first, ForwardIt last) {
+        if (first == last) {
+            return;
+        }
+        base_ = static_cast<Value>(*std::min_element(first, last));
+        Reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) {
+            PushBack(static_cast<Value>(*first));
+        }
+    }
+
+    uint64_t Delta(Value value) const {
+        const uint64_t delta = static_cast<uint64_t>(value) - base_;
+        if (value < base_ || delta > kMaxDelta) {
+            throw std::out_of_range("PackedIntVector: value does not fit");
+        }
+        return delta;
+    }
+
+    packed_detail::WordBuffer words_;
+    size_t size_ = 0;
+    Value base_ = 0;
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Вектор с копированием при записи. Копии SharedVector делят один буфер со счётчиком
+// ссылок, поэтому копирование стоит O(1): так дёшево публиковать снимки таблиц читателям.
+// Чтение (const operator[], итераторы) никогда не копирует; любое изменение сначала
+// вызывает MakeUnique(), который копирует элементы, только если буфер разделён.
+//
+//     SharedVector<Entry> table(std::move(entries));
+//     SharedVector<Entry> snapshot = table;  // O(1)
+//     table.MakeUnique()[0] = entry;        // snapshot не меняется
+//
+// Потокобезопасность та же, что у std::shared_ptr: разные объекты SharedVector, даже
+// разделяющие буфер, можно одновременно читать и изменять из разных потоков; один объект
+// без внешней синхронизации — только читать. Ссылки и итераторы, полученные через копию,
+// остаются действительными, пока жива эта копия.
+template <typename T, typename Alloc = std::allocator<T>>
+class SharedVector {
+    struct Buffer {
+        explicit Buffer(Vector<T, Alloc>&& data)
+            : data(std::move(data)) {
+        }
+        explicit Buffer(const Vector<T, Alloc>& data)
+            : data(data) {
+        }
+
+        std::atomic<size_t> refs{1};
+        Vector<T, Alloc> data;
+    };
+
+public:
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+    SharedVector() = default;
+
+    explicit SharedVector(Vector<T, Alloc>&& data)
+        : buffer_(new Buffer(std::move(data))) {
+    }
+
+    explicit SharedVector(const Vector<T, Alloc>& data)
+        : buffer_(new Buffer(data)) {
+    }
+
+    SharedVector(const SharedVector& other) noexcept
+        : buffer_(other.buffer_) {
+        if (buffer_ != nullptr) {
+            buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedVector(SharedVector&& other) noexcept
+        : buffer_(std::exchange(other.buffer_, nullptr)) {
+    }
+
+    SharedVector& operator=(const SharedVector& rhs) noexcept {
+        if (this != &rhs) {
+            SharedVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SharedVector& operator=(SharedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SharedVector rhs_temp(std::move(rhs));
+            Swap(rhs_temp);
+        }
+        return *this;
+    }
+
+    ~SharedVector() {
+        Release();
+    }
+
+    void Swap(SharedVector& other) noexcept {
+        std::swap(buffer_, other.buffer_);
+    }
+
+    size_t Size() const noexcept {
+        return buffer_ == nullptr ? 0 : buffer_->data.Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return buffer_ == nullptr ? 0 : buffer_->data.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return buffer_->data[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return buffer_ == nullptr ? nullptr : buffer_->data.begin();
+    }
+    const_iterator end() const noexcept {
+        return buffer_ == nullptr ? nullptr : buffer_->data.end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Число объектов SharedVector, разделяющих буфер; при одновременных копиях в других
+    // потоках значение сразу устаревает и годится только для диагностики
+    size_t UseCount() const noexcept {
+        return buffer_ == nullptr ? 0 : buffer_->refs.load(std::memory_order_relaxed);
+    }
+
+    bool IsUnique() const noexcept {
+        return buffer_ == nullptr || buffer_->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    // Делает буфер собственным, копируя его при необходимости, и возвращает его для изменения.
+    // Ссылка действительна до следующего копирования или присваивания этого объекта.
+    // При исключении во время копирования объект не меняется
+    Vector<T, Alloc>& MakeUnique() {
+        if (buffer_ == nullptr) {
+            buffer_ = new Buffer(Vector<T, Alloc>());
+        } else if (!IsUnique()) {
+            Buffer* copy = new Buffer(buffer_->data);
+            Release();
+            buffer_ = copy;
+        }
+        return buffer_->data;
+    }
+
+    T& Mutable(size_t index) {
+        assert(index < Size());
+        return MakeUnique()[index];
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (IsUnique()) {
+            return MakeUnique().EmplaceBack(std::forward<Args>(args)...);
+        }
+        // Аргументы могут ссылаться на разделённый буфер, который MakeUnique отпускает
+        T value(std::forward<Args>(args)...);
+        return MakeUnique().EmplaceBack(std::move(value));
+    }
+
+    void PopBack() {
+        MakeUnique().PopBack();
+    }
+
+    // Не копирует разделённый буфер, а просто отпускает его
+    void Clear() noexcept {
+        if (IsUnique()) {
+            if (buffer_ != nullptr) {
+                buffer_->data.Clear();
+            }
+        } else {
+            Release();
+            buffer_ = nullptr;
+        }
+    }
+
+private:
+    void Release() noexcept {
+        // acq_rel: чтения и записи всех прежних владельцев завершаются до уничтожения буфера
+        if (buffer_ != nullptr && buffer_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete buffer_;
+        }
+    }
+
+    Buffer* buffer_ = nullptr;
+};
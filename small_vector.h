@@ -0,0 +1,336 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+
+// Вектор со встроенным буфером на N элементов: пока размер не превышает N,
+// элементы живут внутри объекта и куча не используется. При переполнении элементы
+// переезжают в RawMemory с теми же гарантиями безопасности исключений, что и у Vector.
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "Use Vector<T> for SmallVector without inline storage");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    SmallVector(size_t size) {
+        if (size > N) {
+            RawMemory<T>(size).Swap(heap_);
+            data_ = heap_.GetAddress();
+        }
+        std::uninitialized_value_construct_n(data_, size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other) {
+        if (other.size_ > N) {
+            RawMemory<T>(other.size_).Swap(heap_);
+            data_ = heap_.GetAddress();
+        }
+        std::uninitialized_copy_n(other.data_, other.size_, data_);
+        size_ = other.size_;
+    }
+
+    // Из кучи буфер забирается за O(1), встроенные элементы переносятся по одному
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (other.IsInline()) {
+            UninitializedMoveIfNoexceptN(other.data_, other.size_, data_);
+            size_ = other.size_;
+            other.DestroyAll();
+        } else {
+            heap_.Swap(other.heap_);
+            data_ = heap_.GetAddress();
+            size_ = std::exchange(other.size_, 0);
+            other.data_ = other.InlineData();
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+
+        if (rhs.size_ > Capacity()) {
+            RawMemory<T> new_data(rhs.size_);
+            std::uninitialized_copy_n(rhs.data_, rhs.size_, new_data.GetAddress());
+            std::destroy_n(data_, size_);
+            heap_.Swap(new_data);
+            data_ = heap_.GetAddress();
+        } else if (rhs.size_ >= size_) {
+            std::copy_n(rhs.data_, size_, data_);
+            std::uninitialized_copy_n(rhs.data_ + size_, rhs.size_ - size_, data_ + size_);
+        } else {
+            std::copy_n(rhs.data_, rhs.size_, data_);
+            std::destroy_n(data_ + rhs.size_, size_ - rhs.size_);
+        }
+        size_ = rhs.size_;
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                       && std::is_nothrow_move_assignable_v<T>) {
+        if (this == &rhs) {
+            return *this;
+        }
+
+        if (!rhs.IsInline()) {
+            DestroyAll();
+            heap_ = std::move(rhs.heap_);
+            data_ = heap_.GetAddress();
+            size_ = std::exchange(rhs.size_, 0);
+            rhs.data_ = rhs.InlineData();
+        } else {
+            // Встроенные элементы rhs помещаются в любой наш буфер: Capacity() >= N
+            if (rhs.size_ >= size_) {
+                std::move(rhs.data_, rhs.data_ + size_, data_);
+                UninitializedMoveIfNoexceptN(rhs.data_ + size_, rhs.size_ - size_, data_ + size_);
+            } else {
+                std::move(rhs.data_, rhs.data_ + rhs.size_, data_);
+                std::destroy_n(data_ + rhs.size_, size_ - rhs.size_);
+            }
+            size_ = rhs.size_;
+            rhs.DestroyAll();
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                           && std::is_nothrow_move_assignable_v<T>) {
+        SmallVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    ~SmallVector() {
+        std::destroy_n(data_, size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы хранятся во встроенном буфере
+    bool IsInline() const noexcept {
+        return data_ == InlineData();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    iterator begin() noexcept {
+        return data_;
+    }
+    iterator end() noexcept {
+        return data_ + size_;
+    }
+    const_iterator begin() const noexcept {
+        return data_;
+    }
+    const_iterator end() const noexcept {
+        return data_ + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Reserve(size_t capacity) {
+        if (capacity <= Capacity()) {
+            return;
+        }
+
+        RawMemory<T> new_data(capacity);
+        RelocateN(data_, size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+        data_ = heap_.GetAddress();
+    }
+
+    void Resize(size_t new_size) {
+        if (size_ > new_size) {
+            std::destroy_n(data_ + new_size, size_ - new_size);
+        } else {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(data_ + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+    void PopBack() {
+        assert(size_ != 0);
+
+        std::destroy_at(data_ + size_ - 1);
+        --size_;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            return *GrowAndEmplace(size_, std::forward<Args>(args)...);
+        }
+
+        T* result = new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return *result;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+
+        if (size_ == Capacity()) {
+            return GrowAndEmplace(index, std::forward<Args>(args)...);
+        }
+        if (index == size_) {
+            return &EmplaceBack(std::forward<Args>(args)...);
+        }
+
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            // args могут ссылаться на сдвигаемые элементы, поэтому новый элемент создаётся до сдвига
+            Slot slot;
+            T* temp = &slot.value;
+            std::construct_at(temp, std::forward<Args>(args)...);
+            MoveBytes(data_ + index, size_ - index, data_ + index + 1);
+            MoveBytes(temp, 1, data_ + index);
+        } else {
+            T temp(std::forward<Args>(args)...);
+            new (data_ + size_) T(std::move(data_[size_ - 1]));
+            try {
+                std::move_backward(data_ + index, data_ + size_ - 1, data_ + size_);
+                data_[index] = std::move(temp);
+            } catch (...) {
+                std::destroy_at(data_ + size_);
+                throw;
+            }
+        }
+        ++size_;
+        return data_ + index;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        const size_t index = pos - begin();
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            std::destroy_at(data_ + index);
+            MoveBytes(data_ + index + 1, size_ - index - 1, data_ + index);
+        } else {
+            std::move(data_ + index + 1, data_ + size_, data_ + index);
+            std::destroy_at(data_ + size_ - 1);
+        }
+        --size_;
+        return data_ + index;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+private:
+    // Хранилище под один T без его конструирования, как Vector::Slot
+    union Slot {
+        constexpr Slot() noexcept {
+        }
+        constexpr ~Slot() {
+        }
+
+        T value;
+    };
+
+    T* InlineData() noexcept {
+        return reinterpret_cast<T*>(inline_);
+    }
+
+    const T* InlineData() const noexcept {
+        return reinterpret_cast<const T*>(inline_);
+    }
+
+    void DestroyAll() noexcept {
+        std::destroy_n(data_, size_);
+        size_ = 0;
+    }
+
+    static void MoveBytes(T* from, size_t n, T* to) noexcept {
+        if (n != 0) {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+
+    static void UninitializedMoveIfNoexceptN(T* from, size_t n, T* to) {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move_n(from, n, to);
+        } else {
+            std::uninitialized_copy_n(from, n, to);
+        }
+    }
+
+    // Переносит элементы в неинициализированную память; источник уничтожается после успеха
+    static void RelocateN(T* from, size_t n, T* to) {
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            MoveBytes(from, n, to);
+        } else {
+            UninitializedMoveIfNoexceptN(from, n, to);
+            std::destroy_n(from, n);
+        }
+    }
+
+    // Переезд в кучу (или в больший буфер кучи) со вставкой нового элемента в позицию index
+    template <typename... Args>
+    T* GrowAndEmplace(size_t index, Args&&... args) {
+        RawMemory<T> new_data(DoublingGrowth::NextCapacity(Capacity(), sizeof(T)));
+        T* new_ptr = new (new_data.GetAddress() + index) T(std::forward<Args>(args)...);
+
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            MoveBytes(data_, index, new_data.GetAddress());
+            MoveBytes(data_ + index, size_ - index, new_ptr + 1);
+        } else {
+            try {
+                UninitializedMoveIfNoexceptN(data_, index, new_data.GetAddress());
+            } catch (...) {
+                std::destroy_at(new_ptr);
+                throw;
+            }
+            try {
+                UninitializedMoveIfNoexceptN(data_ + index, size_ - index, new_ptr + 1);
+            } catch (...) {
+                std::destroy_n(new_data.GetAddress(), index + 1);
+                throw;
+            }
+            std::destroy_n(data_, size_);
+        }
+
+        heap_.Swap(new_data);
+        data_ = heap_.GetAddress();
+        ++size_;
+        return new_ptr;
+    }
+
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+    RawMemory<T> heap_;
+    T* data_ = InlineData();
+    size_t size_ = 0;
+};
@@ -0,0 +1,489 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Вектор записей в виде структуры массивов: каждое поле Ts хранится в собственном
+// столбце RawMemory, а размер и вместимость у столбцов общие. Проходы, которым нужны
+// 2 поля из 8, читают только эти столбцы, и кеш-линии не засоряются остальными полями.
+//
+//     SoaVector<float, float, int> particles;  // x, y, id
+//     particles.EmplaceBack(1.0f, 2.0f, 7);
+//     auto [x, y, id] = particles[0];           // ссылки на элементы столбцов
+//     for (float& value : particles.Column<0>()) {
+//         value *= 2;
+//     }
+//
+// Исключение в любом столбце при росте буфера, вставке, Erase и Resize оставляет вектор
+// неизменным. Строки сдвигаются на месте, только если перемещение всех столбцов не
+// бросает; иначе Emplace и Erase в середине переносят строки целиком в новый буфер той же
+// вместимости, чтобы исключение не оставило строку из полей разных строк.
+template <typename... Ts>
+class SoaVector {
+    static_assert(sizeof...(Ts) > 0, "SoaVector needs at least one column");
+
+    using Columns = std::tuple<RawMemory<Ts>...>;
+
+public:
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    // Строка по значению и ссылки на элементы строки во всех столбцах
+    using Value = std::tuple<Ts...>;
+    using Reference = std::tuple<Ts&...>;
+    using ConstReference = std::tuple<const Ts&...>;
+
+    static constexpr size_t kColumns = sizeof...(Ts);
+
+    // Сдвиг строк на месте не бросает исключений
+    static constexpr bool kNothrowShift =
+        ((std::is_nothrow_move_constructible_v<Ts> && std::is_nothrow_move_assignable_v<Ts>) && ...);
+
+    // Итератор по строкам; разыменование возвращает Reference (ConstReference)
+    template <bool IsConst>
+    class RowIterator {
+        using Owner = std::conditional_t<IsConst, const SoaVector, SoaVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, ConstReference, Reference>;
+        using pointer = void;
+
+        RowIterator() = default;
+        RowIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        RowIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        RowIterator operator++(int) noexcept {
+            return RowIterator(owner_, index_++);
+        }
+        RowIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        RowIterator operator--(int) noexcept {
+            return RowIterator(owner_, index_--);
+        }
+        RowIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        RowIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+        RowIterator operator+(difference_type offset) const noexcept {
+            return RowIterator(owner_, index_ + offset);
+        }
+        friend RowIterator operator+(difference_type offset, const RowIterator& it) noexcept {
+            return it + offset;
+        }
+        RowIterator operator-(difference_type offset) const noexcept {
+            return RowIterator(owner_, index_ - offset);
+        }
+        difference_type operator-(const RowIterator& other) const noexcept {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+
+        bool operator==(const RowIterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+        bool operator!=(const RowIterator& other) const noexcept {
+            return index_ != other.index_;
+        }
+        bool operator<(const RowIterator& other) const noexcept {
+            return index_ < other.index_;
+        }
+        bool operator>(const RowIterator& other) const noexcept {
+            return index_ > other.index_;
+        }
+        bool operator<=(const RowIterator& other) const noexcept {
+            return index_ <= other.index_;
+        }
+        bool operator>=(const RowIterator& other) const noexcept {
+            return index_ >= other.index_;
+        }
+
+        size_t Index() const noexcept {
+            return index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = RowIterator<false>;
+    using const_iterator = RowIterator<true>;
+
+    SoaVector() = default;
+
+    explicit SoaVector(size_t size)
+        : columns_(MakeColumns(size)) {
+        ConstructRows(
+            [this, size](auto column) {
+                std::uninitialized_value_construct_n(Data<column>(), size);
+            },
+            size);
+        size_ = size;
+    }
+
+    SoaVector(const SoaVector& other)
+        : columns_(MakeColumns(other.size_)) {
+        ConstructRows(
+            [this, &other](auto column) {
+                std::uninitialized_copy_n(other.Data<column>(), other.size_, Data<column>());
+            },
+            other.size_);
+        size_ = other.size_;
+    }
+
+    SoaVector(SoaVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    SoaVector& operator=(const SoaVector& rhs) {
+        if (this != &rhs) {
+            SoaVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        DestroyRows(0, size_);
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        ForEachColumn([this, &other](auto column) {
+            std::get<column>(columns_).Swap(std::get<column>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return RowAt(index, std::index_sequence_for<Ts...>{});
+    }
+
+    ConstReference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return const_cast<SoaVector&>(*this).RowAt(index, std::index_sequence_for<Ts...>{});
+    }
+
+    // Непрерывный столбец поля I для векторизованных циклов
+    template <size_t I>
+    std::span<ColumnType<I>> Column() noexcept {
+        return {Data<I>(), size_};
+    }
+
+    template <size_t I>
+    std::span<const ColumnType<I>> Column() const noexcept {
+        return {Data<I>(), size_};
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Reserve(size_t capacity) {
+        if (capacity <= Capacity()) {
+            return;
+        }
+        Columns new_columns = MakeColumns(capacity);
+        RelocateRows(new_columns, 0, size_, 0);
+        FinishRelocation(new_columns);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyRows(new_size, size_);
+        } else if (new_size > size_) {
+            Reserve(new_size);
+            ConstructColumns(
+                [this, new_size](auto column) {
+                    std::uninitialized_value_construct_n(Data<column>() + size_, new_size - size_);
+                },
+                [this, new_size](auto column) {
+                    std::destroy_n(Data<column>() + size_, new_size - size_);
+                });
+        }
+        size_ = new_size;
+    }
+
+    // Аргументы по одному на столбец: args[i] создаёт элемент столбца i
+    template <typename... Args>
+    Reference EmplaceBack(Args&&... args) {
+        return Emplace(size_, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    Reference Emplace(size_t index, Args&&... args) {
+        static_assert(sizeof...(Args) == kColumns, "EmplaceBack/Emplace take one argument per column");
+        assert(index <= size_);
+        auto arg_refs = std::forward_as_tuple(std::forward<Args>(args)...);
+
+        if (size_ == Capacity() || (index != size_ && !kNothrowShift)) {
+            // Новая строка создаётся в новом буфере до переезда: аргументы могут ссылаться на элементы
+            Columns new_columns = MakeColumns(size_ == Capacity() ? NextCapacity() : Capacity());
+            ConstructColumns(
+                [&new_columns, &arg_refs, index](auto column) {
+                    std::construct_at(std::get<column>(new_columns).GetAddress() + index,
+                                      std::get<column>(std::move(arg_refs)));
+                },
+                [&new_columns, index](auto column) {
+                    std::destroy_at(std::get<column>(new_columns).GetAddress() + index);
+                });
+            try {
+                RelocateRows(new_columns, 0, index, 0);
+                try {
+                    RelocateRows(new_columns, index, size_, index + 1);
+                } catch (...) {
+                    DestroyRows(new_columns, 0, index);
+                    throw;
+                }
+            } catch (...) {
+                DestroyRows(new_columns, index, index + 1);
+                throw;
+            }
+            FinishRelocation(new_columns);
+        } else if (index == size_) {
+            ConstructColumns(
+                [this, &arg_refs](auto column) {
+                    std::construct_at(Data<column>() + size_, std::get<column>(std::move(arg_refs)));
+                },
+                [this](auto column) {
+                    std::destroy_at(Data<column>() + size_);
+                });
+        } else if constexpr (kNothrowShift) {
+            // Строка собирается заранее, затем каждый столбец сдвигается, как в Vector::Emplace
+            ShiftAndAssign(index, std::make_from_tuple<Value>(std::move(arg_refs)));
+        }
+        ++size_;
+        return (*this)[index];
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        DestroyRows(size_ - 1, size_);
+        --size_;
+    }
+
+    void Erase(size_t index) {
+        assert(index < size_);
+        if constexpr (kNothrowShift) {
+            ForEachColumn([this, index](auto column) {
+                auto* data = Data<column>();
+                std::move(data + index + 1, data + size_, data + index);
+            });
+            PopBack();
+        } else {
+            Columns new_columns = MakeColumns(Capacity());
+            RelocateRows(new_columns, 0, index, 0);
+            try {
+                RelocateRows(new_columns, index + 1, size_, index);
+            } catch (...) {
+                DestroyRows(new_columns, 0, index);
+                throw;
+            }
+            // Остальные элементы удаляемой строки уничтожит FinishRelocation
+            ForEachColumn([this, index](auto column) {
+                if constexpr (kIsTriviallyRelocatable<ColumnType<column>>) {
+                    std::destroy_at(Data<column>() + index);
+                }
+            });
+            FinishRelocation(new_columns);
+            --size_;
+        }
+    }
+
+private:
+    template <size_t I>
+    ColumnType<I>* Data() noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    const ColumnType<I>* Data() const noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t... Is>
+    Reference RowAt(size_t index, std::index_sequence<Is...>) noexcept {
+        return Reference(std::get<Is>(columns_)[index]...);
+    }
+
+    static Columns MakeColumns(size_t capacity) {
+        return MakeColumns(capacity, std::index_sequence_for<Ts...>{});
+    }
+
+    template <size_t... Is>
+    static Columns MakeColumns(size_t capacity, std::index_sequence<Is...>) {
+        return Columns(RawMemory<Ts>(capacity)...);
+    }
+
+    // Вызывает fn(std::integral_constant<size_t, I>) для каждого столбца I по порядку
+    template <typename Fn>
+    static void ForEachColumn(Fn&& fn) {
+        ForEachColumn(fn, std::index_sequence_for<Ts...>{});
+    }
+
+    template <typename Fn, size_t... Is>
+    static void ForEachColumn(Fn& fn, std::index_sequence<Is...>) {
+        (fn(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    // Выполняет construct для каждого столбца; если столбец k выбросит исключение,
+    // для столбцов 0..k-1 вызывается undo и исключение пробрасывается дальше
+    template <typename Construct, typename Undo>
+    static void ConstructColumns(Construct construct, Undo undo) {
+        size_t done = 0;
+        try {
+            ForEachColumn([&](auto column) {
+                construct(column);
+                ++done;
+            });
+        } catch (...) {
+            ForEachColumn([&](auto column) {
+                if (column < done) {
+                    undo(column);
+                }
+            });
+            throw;
+        }
+    }
+
+    // ConstructColumns для строк [0, count) этого вектора
+    template <typename Construct>
+    void ConstructRows(Construct construct, size_t count) {
+        ConstructColumns(construct, [this, count](auto column) {
+            std::destroy_n(Data<column>(), count);
+        });
+    }
+
+    void DestroyRows(size_t first, size_t last) noexcept {
+        DestroyRows(columns_, first, last);
+    }
+
+    static void DestroyRows(Columns& columns, size_t first, size_t last) noexcept {
+        ForEachColumn([&columns, first, last](auto column) {
+            std::destroy(std::get<column>(columns).GetAddress() + first,
+                         std::get<column>(columns).GetAddress() + last);
+        });
+    }
+
+    // Переносит строки [first, last) в new_columns начиная со строки to. Исходные строки
+    // не трогаются (тривиально перемещаемые копируются побайтово, остальные перемещаются,
+    // только если перемещение не бросает), поэтому при исключении их достаточно оставить
+    void RelocateRows(Columns& new_columns, size_t first, size_t last, size_t to) {
+        ConstructColumns(
+            [this, &new_columns, first, last, to](auto column) {
+                using T = ColumnType<column>;
+                T* from = Data<column>() + first;
+                T* dest = std::get<column>(new_columns).GetAddress() + to;
+                if constexpr (kIsTriviallyRelocatable<T>) {
+                    if (last != first) {
+                        std::memcpy(static_cast<void*>(dest), static_cast<const void*>(from),
+                                    (last - first) * sizeof(T));
+                    }
+                } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+                    std::uninitialized_move_n(from, last - first, dest);
+                } else {
+                    std::uninitialized_copy_n(from, last - first, dest);
+                }
+            },
+            [&new_columns, first, last, to](auto column) {
+                using T = ColumnType<column>;
+                if constexpr (!kIsTriviallyRelocatable<T>) {
+                    std::destroy_n(std::get<column>(new_columns).GetAddress() + to, last - first);
+                }
+            });
+    }
+
+    // Завершает переезд: старые элементы уничтожаются (кроме перенесённых побайтово),
+    // и вектор переходит на new_columns
+    void FinishRelocation(Columns& new_columns) noexcept {
+        ForEachColumn([this](auto column) {
+            using T = ColumnType<column>;
+            if constexpr (!kIsTriviallyRelocatable<T>) {
+                std::destroy_n(Data<column>(), size_);
+            }
+        });
+        ForEachColumn([this, &new_columns](auto column) {
+            std::get<column>(columns_).Swap(std::get<column>(new_columns));
+        });
+    }
+
+    // Сдвигает строки [index, size_) на одну вправо в каждом столбце и помещает row в index.
+    // Память под строку size_ уже выделена. Столбцы сдвигаются по очереди, поэтому
+    // вызывается только при kNothrowShift
+    void ShiftAndAssign(size_t index, Value&& row) noexcept {
+        static_assert(kNothrowShift);
+        ForEachColumn([this, index, &row](auto column) {
+            auto* data = Data<column>();
+            std::construct_at(data + size_, std::move(data[size_ - 1]));
+            std::move_backward(data + index, data + size_ - 1, data + size_);
+            data[index] = std::get<column>(std::move(row));
+        });
+    }
+
+    size_t NextCapacity() const noexcept {
+        const size_t next = DoublingGrowth::NextCapacity(Capacity(), (sizeof(Ts) + ...));
+        return next > size_ ? next : size_ + 1;
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Пул потоков для параллельных операций Vector: Vector(size, pool), Vector(other, pool),
+// Assign(other, pool), Clear(pool).
+//
+// ParallelFor(count, fn) вызывает fn(0), ..., fn(count - 1) на потоках пула и на вызывающем
+// потоке и возвращается, когда все вызовы завершены. Если какой-то вызов выбросит исключение,
+// ещё не начатые задачи пропускаются, а первое исключение пробрасывается вызывающему.
+// Одновременно выполняется один ParallelFor; вызывать его из задачи того же пула нельзя.
+class ThreadPool {
+public:
+    // concurrency — общее число потоков вместе с вызывающим
+    explicit ThreadPool(size_t concurrency = std::thread::hardware_concurrency()) {
+        for (size_t i = 1; i < concurrency; ++i) {
+            workers_.emplace_back([this] {
+                WorkerLoop();
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard guard(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t Concurrency() const noexcept {
+        return workers_.size() + 1;
+    }
+
+    template <typename Fn>
+    void ParallelFor(size_t count, Fn&& fn) {
+        if (count == 0) {
+            return;
+        }
+        Job job;
+        job.count = count;
+        job.fn = &fn;
+        job.invoke = [](void* fn, size_t index) {
+            (*static_cast<std::remove_reference_t<Fn>*>(fn))(index);
+        };
+
+        std::lock_guard call_guard(call_mutex_);
+        if (count > 1 && !workers_.empty()) {
+            {
+                std::lock_guard guard(mutex_);
+                job_ = &job;
+                ++generation_;
+            }
+            wake_.notify_all();
+        }
+        Run(job);
+        {
+            // Опоздавшие потоки больше не подключаются к задаче, подключившиеся дорабатывают
+            std::unique_lock lock(mutex_);
+            job_ = nullptr;
+            done_.wait(lock, [this] {
+                return active_ == 0;
+            });
+        }
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct Job {
+        void (*invoke)(void*, size_t) = nullptr;
+        void* fn = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    static void Run(Job& job) noexcept {
+        for (size_t index = job.next.fetch_add(1); index < job.count; index = job.next.fetch_add(1)) {
+            if (job.failed.load(std::memory_order_relaxed)) {
+                break;
+            }
+            try {
+                job.invoke(job.fn, index);
+            } catch (...) {
+                std::lock_guard guard(job.error_mutex);
+                if (!job.error) {
+                    job.error = std::current_exception();
+                }
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void WorkerLoop() {
+        size_t seen = 0;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this, seen] {
+                return stop_ || generation_ != seen;
+            });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            Job* job = job_;
+            if (job == nullptr) {
+                continue;
+            }
+            ++active_;
+            lock.unlock();
+            Run(*job);
+            lock.lock();
+            if (--active_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex call_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job* job_ = nullptr;
+    size_t generation_ = 0;
+    size_t active_ = 0;
+    bool stop_ = false;
+};
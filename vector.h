@@ -4,254 +4,675 @@
 #include <new>
 #include <utility>
 #include <memory>
-#include <cstdint> 
+#include <memory_resource>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <source_location>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Тип, объект которого можно перенести на новое место побайтовым копированием,
+// после чего старое место считается свободным без вызова деструктора.
+// По умолчанию это тривиально копируемые типы; собственные типы (например, владеющие
+// дескрипторы в духе unique_ptr) подключаются специализацией:
+//
+//     template <>
+//     struct IsTriviallyRelocatable<Handle> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
 
 template <typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+// Аллокатор умеет менять размер блока на месте (в духе realloc):
+// Alloc::reallocate(p, old_n, new_n) возвращает {ptr, count}, как allocate_at_least: новый адрес
+// и вместимость нового блока (count >= new_n); содержимое переносится побайтово
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename std::allocator_traits<Alloc>::pointer>(), size_t{}, size_t{}).count)>>
+    : std::true_type {};
+
+// Аллокатор может вернуть больше памяти, чем просили (в духе allocate_at_least из C++23):
+// Alloc::allocate_at_least(n) возвращает {ptr, count}, где count >= n
+template <typename Alloc, typename = void>
+struct HasAllocateAtLeast : std::false_type {};
+
+template <typename Alloc>
+struct HasAllocateAtLeast<Alloc, std::void_t<decltype(std::declval<Alloc&>().allocate_at_least(size_t{}).count)>>
+    : std::true_type {};
+
+// Аллокатор сам создаёт объекты (например, std::pmr::polymorphic_allocator); тогда
+// тривиально копируемые элементы нельзя копировать одним memcpy в обход Alloc::construct
+template <typename Alloc, typename T, typename = void>
+struct HasConstruct : std::false_type {};
+
+template <typename Alloc, typename T>
+struct HasConstruct<Alloc, T, std::void_t<decltype(std::declval<Alloc&>().construct(
+    std::declval<T*>(), std::declval<const T&>()))>> : std::true_type {};
+
+// Исполнитель параллельных операций Vector: Concurrency() — число потоков,
+// ParallelFor(n, fn) вызывает fn(0), ..., fn(n - 1) и дожидается всех вызовов,
+// пробрасывая исключение. Реализация — ThreadPool из thread_pool.h
+template <typename Executor, typename = void>
+struct IsParallelExecutor : std::false_type {};
+
+template <typename Executor>
+struct IsParallelExecutor<Executor, std::void_t<decltype(size_t{std::declval<Executor&>().Concurrency()}),
+    decltype(std::declval<Executor&>().ParallelFor(size_t{}, std::declval<void (*)(size_t)>()))>>
+    : std::true_type {};
+
+template <typename Executor>
+using RequireParallelExecutor = std::enable_if_t<IsParallelExecutor<Executor>::value>;
+
+inline constexpr size_t kCacheLineSize = 64;
+
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
 public:
-    RawMemory() = default;
+    using allocator_type = Alloc;
+
+    static constexpr bool kCanReallocate = HasReallocate<Alloc>::value;
+    static constexpr bool kCanAllocateAtLeast = HasAllocateAtLeast<Alloc>::value;
+
+    constexpr RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
-        , capacity_(capacity) {
+    constexpr explicit RawMemory(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Если аллокатор сообщает реальный размер блока, лишнее место становится вместимостью,
+    // поэтому Capacity() может оказаться больше запрошенной
+    constexpr explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : alloc_(alloc) {
+        Allocate(capacity);
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
-    RawMemory(RawMemory&& other) noexcept {
+    constexpr RawMemory(RawMemory&& other) noexcept
+        : alloc_(other.alloc_) {
         buffer_ = other.buffer_;
         capacity_ = other.capacity_;
 
         other.buffer_ = nullptr;
         other.capacity_ = 0;
     }
-    RawMemory& operator=(RawMemory&& rhs) noexcept { 
+    // Буфер всегда переезжает вместе со своим аллокатором: решать, можно ли
+    // распространять аллокатор, должен владелец (Vector)
+    constexpr RawMemory& operator=(RawMemory&& rhs) noexcept {
         if(this == &rhs){
             return *this;
         }
         Deallocate(buffer_);
+        if constexpr (std::is_copy_assignable_v<Alloc>) {
+            alloc_ = rhs.alloc_;
+        } else {
+            assert(alloc_ == rhs.alloc_);
+        }
         buffer_ = rhs.buffer_;
         capacity_ = rhs.capacity_;
 
         rhs.buffer_ = nullptr;
         rhs.capacity_ = 0;
-        
+
         return *this;
     }
 
-    ~RawMemory() {
+    constexpr ~RawMemory() {
         Deallocate(buffer_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    constexpr T* operator+(size_t offset) noexcept {
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    constexpr const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    constexpr void Swap(RawMemory& other) noexcept {
+        if constexpr (std::is_swappable_v<Alloc>) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    constexpr const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    constexpr T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    constexpr size_t Capacity() const {
         return capacity_;
     }
 
+    constexpr const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    constexpr Alloc& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    // Меняет вместимость, перенося содержимое побайтово, поэтому годится только
+    // для тривиально перемещаемых элементов. При исключении буфер не меняется
+    void Reallocate(size_t new_capacity) {
+        static_assert(kCanReallocate, "Allocator does not support reallocate");
+        assert(new_capacity != 0);
+        auto result = alloc_.reallocate(buffer_, capacity_, new_capacity);
+        assert(result.count >= new_capacity);
+        buffer_ = result.ptr;
+        capacity_ = result.count;
+    }
+
 private:
-    
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+
+    constexpr void Allocate(size_t n) {
+        if (n == 0) {
+            return;
+        }
+        if constexpr (kCanAllocateAtLeast) {
+            auto result = alloc_.allocate_at_least(n);
+            assert(result.count >= n);
+            buffer_ = result.ptr;
+            capacity_ = result.count;
+        } else {
+            buffer_ = AllocTraits::allocate(alloc_, n);
+            capacity_ = n;
+        }
     }
 
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    constexpr void Deallocate(T* buf) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, capacity_);
+        }
     }
 
+    [[no_unique_address]] Alloc alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
-}; 
+};
 
 
-template <typename T>
+// Политики роста задают вместимость, до которой вектор расширяется при вставке
+// в заполненный буфер: NextCapacity(capacity, sizeof(T)) должна вернуть больше capacity
+
+// Удвоение: минимум реаллокаций ценой до двукратного запаса памяти
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t /*element_size*/) noexcept {
+        return capacity == 0 ? 1 : capacity * 2;
+    }
+};
+
+// Рост в полтора раза: меньше неиспользуемой памяти, больше реаллокаций
+struct OneAndHalfGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t /*element_size*/) noexcept {
+        return capacity < 2 ? capacity + 1 : capacity + capacity / 2;
+    }
+};
+
+// Пропускает первые мелкие реаллокации: пустой вектор сразу получает MinCapacity мест
+template <size_t MinCapacity, typename Base = DoublingGrowth>
+struct MinCapacityGrowth {
+    static_assert(MinCapacity > 0);
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t element_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, element_size);
+        return next < MinCapacity ? MinCapacity : next;
+    }
+};
+
+// Буферы от страницы и больше округляются вверх до целого числа страниц,
+// чтобы хвост последней страницы не пропадал зря
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t element_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, element_size);
+        const size_t bytes = next * element_size;
+        if (bytes < PageSize) {
+            return next;
+        }
+        const size_t rounded = (bytes + PageSize - 1) & ~(PageSize - 1);
+        return rounded / element_size;
+    }
+};
+
+// Политики возврата памяти. После каждого уменьшения размера вектор вызывает
+// OnShrink(state, used, capacity, sizeof(T)), где used — новый размер (для Clear — размер
+// до очистки, то есть занятость за прошедший цикл). Вместимость меньше текущей — просьба
+// ужать буфер; политика повторяет её, пока вектор не выполнит просьбу и не сбросит State.
+// State хранится в каждом векторе и сбрасывается также при росте.
+//
+// Ужимают буфер только Clear, уменьшающие Resize и ResizeDefaultInit и присваивание
+// выражения — как и переезд при росте, это делает недействительными все итераторы,
+// указатели и ссылки. Erase, EraseIf, EraseUnordered и PopBack лишь сообщают политике
+// занятость и никогда не перевыделяют память, так что итераторы перед удалённым местом
+// и возвращённый итератор остаются действительными; накопленная ими просьба выполняется
+// при следующем Clear или Resize.
+// Буфер от kReleasePagesBytes байт не переезжает: вместо этого неиспользуемые страницы
+// возвращаются системе через ReleaseUnusedPages. По умолчанию буфер не ужимается
+struct NoShrink {
+    static constexpr size_t kReleasePagesBytes = SIZE_MAX;
+
+    struct State {};
+
+    static constexpr size_t OnShrink(State&, size_t /*used*/, size_t capacity, size_t /*element_size*/) noexcept {
+        return capacity;
+    }
+};
+
+// Ужимает буфер, когда занятость Patience раз подряд не превышает 1/Threshold вместимости.
+// Новая вместимость вдвое больше занятой, поэтому до следующего роста или сжатия размер
+// должен ещё раз измениться вдвое — векторы с колеблющимся размером не перевыделяют память
+// на каждом цикле. Буферы меньше MinBytes не ужимаются
+template <size_t Threshold = 4, size_t Patience = 8, size_t MinBytes = 4096, size_t ReleasePagesBytes = 64 << 20>
+struct HysteresisShrink {
+    static_assert(Threshold >= 2, "Shrinking at more than half of the capacity would thrash");
+    static_assert(Patience > 0);
+
+    static constexpr size_t kReleasePagesBytes = ReleasePagesBytes;
+
+    struct State {
+        size_t low_streak = 0;
+    };
+
+    static constexpr size_t OnShrink(State& state, size_t used, size_t capacity, size_t element_size) noexcept {
+        if (capacity * element_size < MinBytes || used > capacity / Threshold) {
+            state.low_streak = 0;
+            return capacity;
+        }
+        if (state.low_streak < Patience) {
+            ++state.low_streak;
+        }
+        if (state.low_streak < Patience) {
+            return capacity;
+        }
+        return std::max(used * 2, MinBytes / element_size);
+    }
+};
+
+// Политика статистики вектора. Site — состояние, которое хранит каждый экземпляр
+// (например, место создания), хуки вызываются при выделении памяти, росте,
+// переносе элементов и уничтожении вектора. DetachedSite() — место, хуки которого
+// ничего не учитывают: его получают перемещённые векторы и внутренние временные.
+// Политика по умолчанию ничего не делает: хуки пусты, Site пуст и не занимает места,
+// так что код компилируется как без статистики.
+// Собирающая статистику политика — CountingVectorStats из vector_stats.h
+struct NoVectorStats {
+    struct Site {};
+
+    static constexpr Site MakeSite(const std::source_location&) noexcept {
+        return {};
+    }
+    static constexpr Site DetachedSite() noexcept {
+        return {};
+    }
+    static constexpr void OnAllocate(Site&, size_t /*bytes*/) noexcept {
+    }
+    static constexpr void OnGrow(Site&, size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+    }
+    static constexpr void OnRelocate(Site&, size_t /*moved*/, size_t /*copied*/) noexcept {
+    }
+    static constexpr void OnDestroy(Site&, size_t /*size*/, size_t /*capacity*/) noexcept {
+    }
+};
+
+// Метка конструктора, который инициализирует элементы по умолчанию, а не значением:
+// Vector<double>(n, kDefaultInit) не зануляет память, которая всё равно будет перезаписана
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag kDefaultInit{};
+
+// Ленивое поэлементное выражение (см. vector_expr.h): Size() элементов, i-й — expr[i].
+// Vector вычисляет его при присваивании одним циклом, без промежуточных буферов
+template <typename E>
+concept VectorExpression = requires(const E& expr, size_t index) {
+    typename E::IsVectorExpression;
+    { expr.Size() } -> std::convertible_to<size_t>;
+    expr[index];
+};
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+// Отсекает перегрузки с парой итераторов от вызовов вида Vector<int>(n, alloc)
+template <typename It>
+using RequireInputIterator = std::enable_if_t<std::is_convertible_v<IteratorCategory<It>, std::input_iterator_tag>>;
+
+template <typename It>
+inline constexpr bool kIsForwardIterator = std::is_convertible_v<IteratorCategory<It>, std::forward_iterator_tag>;
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth,
+          typename Stats = NoVectorStats, typename Shrink = NoShrink>
 class Vector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Memory = RawMemory<T, Alloc>;
+
+    static constexpr bool kPropagateOnCopy = AllocTraits::propagate_on_container_copy_assignment::value;
+    static constexpr bool kPropagateOnMove = AllocTraits::propagate_on_container_move_assignment::value;
+    static constexpr bool kPropagateOnSwap = AllocTraits::propagate_on_container_swap::value;
+    static constexpr bool kAlwaysEqual = AllocTraits::is_always_equal::value;
+    // Копия элемента — копия его байтов, и аллокатор не вмешивается в создание объектов
+    static constexpr bool kIsBitwiseCopyable = std::is_trivially_copyable_v<T> && !HasConstruct<Alloc, T>::value;
+
+    // Меньшие куски не окупают передачу работы другому потоку
+    static constexpr size_t kParallelMinChunkBytes = 64 * 1024;
+
 public:
+    using value_type = T;
+    using allocator_type = Alloc;
 
-    Vector() = default;
+    constexpr Vector() = default;
 
-    Vector(size_t size) : data_(size), size_(size) {
-    
-        std::uninitialized_value_construct_n(data_.GetAddress(), size_);
+    constexpr explicit Vector(const Alloc& alloc) noexcept : data_(alloc) {
     }
 
-    Vector(const Vector& other) : data_(other.size_), size_(other.size_){
+    // Конструкторы, которые сразу выделяют память, относят статистику вектора к месту вызова
+    // (см. SetStatsSite); вектор, созданный пустым, остаётся в общей записи до SetStatsSite
+    constexpr Vector(size_t size, const Alloc& alloc = Alloc(),
+                     const std::source_location& location = std::source_location::current())
+        : data_(size, alloc)
+        , size_(size)
+        , stats_(Stats::MakeSite(location)) {
+        NoteAllocation(data_.Capacity());
+        UninitializedValueConstructN(data_.GetAddress(), size_);
+    }
+
+    constexpr Vector(size_t size, DefaultInitTag, const Alloc& alloc = Alloc(),
+                     const std::source_location& location = std::source_location::current())
+        : data_(size, alloc)
+        , size_(size)
+        , stats_(Stats::MakeSite(location)) {
+        NoteAllocation(data_.Capacity());
+        UninitializedDefaultConstructN(data_.GetAddress(), size_);
+    }
 
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+    // Для прямых итераторов память выделяется один раз, входные читаются поэлементно
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr Vector(InputIt first, InputIt last, const Alloc& alloc = Alloc(),
+                     const std::source_location& location = std::source_location::current())
+        : Vector(first, last, alloc, Stats::MakeSite(location)) {
     }
 
-    Vector(Vector&& other) noexcept : data_(std::move(other.data_)), size_(other.size_) {
+    constexpr Vector(std::initializer_list<T> init, const Alloc& alloc = Alloc(),
+                     const std::source_location& location = std::source_location::current())
+        : Vector(init.begin(), init.end(), alloc, Stats::MakeSite(location)) {
+    }
+
+    template <VectorExpression Expr>
+    constexpr Vector(const Expr& expr, const Alloc& alloc = Alloc(),
+                     const std::source_location& location = std::source_location::current())
+        : data_(expr.Size(), alloc)
+        , size_(expr.Size())
+        , stats_(Stats::MakeSite(location)) {
+        NoteAllocation(data_.Capacity());
+        EvaluateInto(data_.GetAddress(), expr);
+    }
+
+    // Копия относится к месту, где её создают, а не к месту создания оригинала
+    constexpr Vector(const Vector& other, const std::source_location& location = std::source_location::current())
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()),
+                 Stats::MakeSite(location)) {
+    }
+
+    constexpr Vector(const Vector& other, const Alloc& alloc,
+                     const std::source_location& location = std::source_location::current())
+        : Vector(other, alloc, Stats::MakeSite(location)) {
+    }
+
+    // Параллельные варианты для очень больших векторов: элементы делятся на куски по границам
+    // кеш-линий, и каждый кусок обрабатывает свой поток executor (например, ThreadPool).
+    // Если конструктор какого-то элемента выбросит исключение, все уже созданные элементы
+    // уничтожаются, как и в последовательных вариантах:
+    //
+    //     ThreadPool pool;
+    //     Vector<double> snapshot(1'000'000'000, pool);
+    //     Vector<double> copy(snapshot, pool);
+    //     copy.Clear(pool);
+    template <typename Executor, typename = RequireParallelExecutor<Executor>>
+    Vector(size_t size, Executor& executor, const Alloc& alloc = Alloc(),
+           const std::source_location& location = std::source_location::current())
+        : data_(size, alloc)
+        , size_(size)
+        , stats_(Stats::MakeSite(location)) {
+        NoteAllocation(data_.Capacity());
+        ParallelConstructN(executor, data_.GetAddress(), size_, [this](T* to, size_t, size_t count) {
+            UninitializedValueConstructN(to, count);
+        });
+    }
+
+    template <typename Executor, typename = RequireParallelExecutor<Executor>>
+    Vector(const Vector& other, Executor& executor,
+           const std::source_location& location = std::source_location::current())
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()), executor,
+                 Stats::MakeSite(location)) {
+    }
+
+    template <typename Executor, typename = RequireParallelExecutor<Executor>>
+    Vector(const Vector& other, const Alloc& alloc, Executor& executor,
+           const std::source_location& location = std::source_location::current())
+        : Vector(other, alloc, executor, Stats::MakeSite(location)) {
+    }
+
+    // Перемещённый вектор уносит своё место с собой, а other отвязывается от него:
+    // его дальнейшая судьба не учитывается, пока ему не назначат место заново
+    constexpr Vector(Vector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(other.size_)
+        , stats_(std::exchange(other.stats_, Stats::DetachedSite())) {
         other.size_ = 0;
     }
 
-    Vector& operator=(const Vector& rhs){
+    // Если аллокаторы не равны, буфер other забрать нельзя, и элементы перемещаются по одному
+    constexpr Vector(Vector&& other, const Alloc& alloc)
+        : Vector(std::move(other), alloc, std::exchange(other.stats_, Stats::DetachedSite())) {
+    }
+
+    constexpr Vector& operator=(const Vector& rhs){
         if(this == &rhs){
             return *this;
         }
 
+        if constexpr (kPropagateOnCopy && !kAlwaysEqual) {
+            if (GetAllocator() != rhs.GetAllocator()) {
+                // Наши элементы нужно уничтожить своим аллокатором до того, как он будет заменён.
+                // Память временного вектора учитывается за этим вектором, а сам он, как и
+                // остальные временные векторы методов, отвязывается, чтобы не считаться уничтоженным
+                Vector rhs_temp(rhs, rhs.GetAllocator(), stats_);
+                rhs_temp.stats_ = Stats::DetachedSite();
+                DestroyN(data_.GetAddress(), size_);
+                data_ = std::move(rhs_temp.data_);
+                size_ = std::exchange(rhs_temp.size_, 0);
+                return *this;
+            }
+        }
+
         if(rhs.size_ > this->Capacity()){
-            Vector rhs_temp(rhs);
+            Vector rhs_temp(rhs, GetAllocator(), stats_);
+            rhs_temp.stats_ = Stats::DetachedSite();
             Swap(rhs_temp);
         } else{
             if(rhs.size_ >= size_){
-                for(size_t i = 0; i < size_; i++ ){
-                    data_[i] = rhs.data_[i];
-                }
-                for(size_t i = size_; i < rhs.size_; i++){
-                    new(data_+i) T(rhs.data_[i]);
-                }
+                std::copy_n(rhs.data_.GetAddress(), size_, data_.GetAddress());
+                UninitializedCopyN(rhs.data_ + size_, rhs.size_ - size_, data_ + size_);
             } else{
-                for(size_t i = 0; i < rhs.size_; i++ ){
-                    data_[i] = rhs.data_[i];
-                }
-                for(size_t i = rhs.size_; i < size_; i++){
-                    Destroy(data_+i);
-                }
+                std::copy_n(rhs.data_.GetAddress(), rhs.size_, data_.GetAddress());
+                DestroyN(data_ + rhs.size_, size_ - rhs.size_);
             }
         }
         size_ = rhs.size_;
         return *this;
     }
-    Vector& operator=(Vector&& rhs) noexcept {
+    constexpr Vector& operator=(Vector&& rhs) noexcept(kPropagateOnMove || kAlwaysEqual) {
     if (this != &rhs) {
-        data_.Swap(rhs.data_);
-        std::swap(size_, rhs.size_);
+        if (kPropagateOnMove || kAlwaysEqual || GetAllocator() == rhs.GetAllocator()) {
+            data_.Swap(rhs.data_);
+            std::swap(size_, rhs.size_);
+            std::swap(shrink_, rhs.shrink_);
+        } else {
+            Vector rhs_temp(std::move(rhs), GetAllocator(), stats_);
+            rhs_temp.stats_ = Stats::DetachedSite();
+            Swap(rhs_temp);
+        }
     }
     return *this;
 }
 
-    void Swap(Vector& other) noexcept{
+    // Вычисляет выражение одним циклом. Существующая вместимость переиспользуется, а при
+    // нехватке буфер выделяется ровно под результат. Выражение может читать сам вектор
+    // (v = v * 2 + w): элемент i читается до записи в i, а новый буфер заполняется
+    // до освобождения старого
+    template <VectorExpression Expr>
+    constexpr Vector& operator=(const Expr& expr) {
+        const size_t count = expr.Size();
+        if (count > Capacity()) {
+            Memory new_data(count, data_.GetAllocator());
+            NoteAllocation(new_data.Capacity());
+            EvaluateInto(new_data.GetAddress(), expr);
+            data_.Swap(new_data);
+            size_ = count;
+            return *this;
+        }
+        EvaluateInto(data_.GetAddress(), expr);
+        const size_t old_size = std::exchange(size_, count);
+        if (count < old_size) {
+            NoteShrink(count);
+        }
+        return *this;
+    }
+
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap,
+    // иначе они обязаны быть равны
+    constexpr void Swap(Vector& other) noexcept{
+        if constexpr (!kPropagateOnSwap && !kAlwaysEqual) {
+            assert(GetAllocator() == other.GetAllocator());
+        }
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
+        std::swap(shrink_, other.shrink_);
+    }
+
+    constexpr ~Vector(){
+        Stats::OnDestroy(stats_, size_, Capacity());
+        DestroyN(data_.GetAddress(), size_);
     }
 
-    ~Vector(){
-        std::destroy_n(data_.GetAddress(), size_);
+    constexpr Alloc GetAllocator() const noexcept {
+        return data_.GetAllocator();
     }
 
-    size_t Size() const noexcept {
+    // Относит дальнейшую статистику этого вектора к месту вызова. Нужен векторам,
+    // созданным пустыми, и перемещённым, которые снова используются:
+    //
+    //     Vector<int, std::allocator<int>, DoublingGrowth, CountingVectorStats> ids;
+    //     ids.SetStatsSite();
+    void SetStatsSite(const std::source_location& site = std::source_location::current()) {
+        stats_ = Stats::MakeSite(site);
+    }
+
+    constexpr size_t Size() const noexcept {
         return size_;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < size_);
         return data_[index];
     }
 
     using iterator = T*;
     using const_iterator = const T*;
-    
-    iterator begin() noexcept{
+
+    constexpr iterator begin() noexcept{
         return data_.GetAddress();
     };
 
-    iterator end() noexcept{
+    constexpr iterator end() noexcept{
         return data_.GetAddress()+size_;
     };
-    const_iterator begin() const noexcept{
+    constexpr const_iterator begin() const noexcept{
         return data_.GetAddress();
     };
-    const_iterator end() const noexcept{
+    constexpr const_iterator end() const noexcept{
         return data_.GetAddress()+size_;
     };
-    const_iterator cbegin() const noexcept{
+    constexpr const_iterator cbegin() const noexcept{
         return begin();
     };
-    const_iterator cend() const noexcept{
+    constexpr const_iterator cend() const noexcept{
         return end();
     };
 
 
 template <typename... Args>
-iterator Emplace(const_iterator pos, Args&&... args) {
+constexpr iterator Emplace(const_iterator pos, Args&&... args) {
     assert(pos >= begin() && pos <= end());
     size_t index = pos - begin();
     T* ptr = data_.GetAddress();
 
     if (size_ == Capacity()) {
-        size_t new_capacity = size_ == 0 ? 1 : size_ * 2;
-        RawMemory<T> new_data(new_capacity);
-        T* new_ptr = new_data.GetAddress() + index;
-
-        size_t constructed = 0;
-
-        try {
-            new (new_ptr) T(std::forward<Args>(args)...);
-            ++constructed;
-
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(ptr, index, new_data.GetAddress());
-            } else {
-                std::uninitialized_copy_n(ptr, index, new_data.GetAddress());
-            }
-            constructed += index;
-
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(ptr + index, size_ - index, new_data.GetAddress() + index + 1);
-            } else {
-                std::uninitialized_copy_n(ptr + index, size_ - index, new_data.GetAddress() + index + 1);
-            }
-            constructed += size_ - index;
-
-        } catch (...) {
-
-            for (size_t i = 0; i < constructed; ++i) {
-                std::destroy_at(new_data.GetAddress() + i);
-            }
-            throw;
-        }
-
-        std::destroy_n(ptr, size_);
-        data_.Swap(new_data);
-        ++size_;
-        return begin() + index;
+        return GrowAndEmplace(index, NextCapacity(), std::forward<Args>(args)...);
 
     } else {
         iterator mutable_pos = begin() + index;
 
         if (index == size_) {
-            T* new_elem = new (ptr + size_) T(std::forward<Args>(args)...);
+            T* new_elem = ptr + size_;
+            Construct(new_elem, std::forward<Args>(args)...);
             ++size_;
             return new_elem;
+        } else if constexpr (kIsTriviallyRelocatable<T>) {
+            // args могут ссылаться на сдвигаемые элементы, поэтому новый элемент создаётся до сдвига
+            Slot slot;
+            T* temp = &slot.value;
+            Construct(temp, std::forward<Args>(args)...);
+            MoveBytes(ptr + index, size_ - index, ptr + index + 1);
+            MoveBytes(temp, 1, ptr + index);
+            ++size_;
+            return mutable_pos;
         } else {
             T temp(std::forward<Args>(args)...);
             size_t constructed = 0;
 
             try {
-                new (ptr + size_) T(std::move(ptr[size_ - 1]));
+                Construct(ptr + size_, std::move(ptr[size_ - 1]));
                 ++constructed;
                 std::move_backward(ptr + index, ptr + size_ - 1, ptr + size_);
 
@@ -259,7 +680,7 @@ iterator Emplace(const_iterator pos, Args&&... args) {
                 ++size_;
             } catch (...) {
                 if (constructed) {
-                    std::destroy_at(ptr + size_);
+                    Destroy(ptr + size_);
                 }
                 throw;
             }
@@ -269,118 +690,949 @@ iterator Emplace(const_iterator pos, Args&&... args) {
     }
 }
 
-    iterator Erase(const_iterator pos) {
+    constexpr iterator Erase(const_iterator pos) {
         assert(pos >= begin() && pos < end());
         size_t index = pos - begin();
-        std::move(begin() + index + 1, end(), begin() + index);
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            T* ptr = data_.GetAddress();
+            Destroy(ptr + index);
+            MoveBytes(ptr + index + 1, size_ - index - 1, ptr + index);
+            --size_;
+        } else {
+            std::move(begin() + index + 1, end(), begin() + index);
+            --size_;
+            Destroy(data_.GetAddress() + size_);
+        }
+        RecordShrink(size_);
+        return begin() + index;
+    }
+
+    // Удаление диапазона одним сдвигом хвоста. Тривиально перемещаемые элементы
+    // сдвигаются memmove и операция не бросает; иначе гарантия базовая: если бросит
+    // перемещающее присваивание, размер не меняется, а часть элементов остаётся перемещённой
+    constexpr iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= begin() && first <= last && last <= end());
+        const size_t index = first - begin();
+        const size_t count = last - first;
+        if (count == 0) {
+            return begin() + index;
+        }
+        T* ptr = data_.GetAddress();
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            DestroyN(ptr + index, count);
+            MoveBytes(ptr + index + count, size_ - index - count, ptr + index);
+        } else {
+            std::move(ptr + index + count, ptr + size_, ptr + index);
+            DestroyN(ptr + size_ - count, count);
+        }
+        size_ -= count;
+        RecordShrink(size_);
+        return begin() + index;
+    }
+
+    // Удаляет все элементы, для которых pred истинен, за один проход с сохранением порядка;
+    // удалённые элементы уничтожаются один раз в конце. Возвращает число удалённых.
+    // Гарантия базовая: если бросит pred (или перемещающее присваивание), уже отобранные
+    // к удалению элементы у тривиально перемещаемых типов удаляются, у остальных размер
+    // не меняется, но часть элементов остаётся перемещённой
+    template <typename Pred>
+    constexpr size_t EraseIf(Pred pred) {
+        T* ptr = data_.GetAddress();
+        const size_t old_size = size_;
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            size_t kept = 0;
+            size_t i = 0;
+            try {
+                for (; i < size_; ++i) {
+                    if (pred(std::as_const(ptr[i]))) {
+                        Destroy(ptr + i);
+                    } else {
+                        if (kept != i) {
+                            MoveBytes(ptr + i, 1, ptr + kept);
+                        }
+                        ++kept;
+                    }
+                }
+            } catch (...) {
+                // Закрываем дыру: непроверенный хвост переносится вслед за оставленными элементами
+                MoveBytes(ptr + i, size_ - i, ptr + kept);
+                size_ = kept + (size_ - i);
+                throw;
+            }
+            size_ = kept;
+        } else {
+            T* new_end = std::remove_if(ptr, ptr + size_, [&pred](const T& value) {
+                return pred(value);
+            });
+            DestroyN(new_end, ptr + size_ - new_end);
+            size_ = new_end - ptr;
+        }
+        if (size_ != old_size) {
+            RecordShrink(size_);
+        }
+        return old_size - size_;
+    }
+
+    // Удаление за O(1): на место элемента переносится последний, порядок не сохраняется.
+    // Возвращает итератор на элемент, занявший место удалённого (или end()).
+    // Для тривиально перемещаемых типов не бросает; иначе гарантия та же,
+    // что у перемещающего присваивания T
+    constexpr iterator EraseUnordered(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        const size_t index = pos - begin();
+        T* ptr = data_.GetAddress();
+        T* last = ptr + size_ - 1;
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            Destroy(ptr + index);
+            if (ptr + index != last) {
+                MoveBytes(last, 1, ptr + index);
+            }
+        } else {
+            if (ptr + index != last) {
+                ptr[index] = std::move(*last);
+            }
+            Destroy(last);
+        }
         --size_;
-        std::destroy_at(data_.GetAddress() + size_);
+        RecordShrink(size_);
         return begin() + index;
     }
 
-    iterator Insert(const_iterator pos, const T& value) { 
-        return Emplace(pos, value); 
-    } 
- 
-    iterator Insert(const_iterator pos, T&& value) { 
-        return Emplace(pos, std::move(value)); 
+    constexpr iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
     }
-    
-    void Reserve(size_t capacity){
-        if(capacity <= data_.Capacity()){
+
+    constexpr iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Вставка диапазона. Для прямых итераторов итоговый размер вычисляется заранее:
+    // не более одной реаллокации и один сдвиг хвоста. Гарантии те же, что у Emplace:
+    // строгая при реаллокации, базовая при вставке на месте.
+    // Входные итераторы читаются по одному элементу в конец вектора, затем хвост
+    // поворачивается на место. Если бросит итератор или конструктор, добавленные элементы
+    // удаляются и вектор возвращается к прежним элементам (вместимость может остаться
+    // увеличенной); исключение из перемещения при повороте даёт базовую гарантию.
+    // Диапазон может указывать на элементы самого вектора
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+
+        if constexpr (kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            if constexpr (std::is_pointer_v<InputIt>) {
+                if (count != 0 && Overlaps(&*first, count)) {
+                    // Сдвиг хвоста испортил бы исходный диапазон, поэтому сначала копируем его
+                    Vector temp(first, last, GetAllocator(), stats_);
+                    temp.stats_ = Stats::DetachedSite();
+                    return InsertN(index, std::make_move_iterator(temp.begin()), count);
+                }
+            }
+            return InsertN(index, first, count);
+        } else {
+            const size_t old_size = size_;
+            try {
+                for (; first != last; ++first) {
+                    EmplaceBack(*first);
+                }
+            } catch (...) {
+                DestroyN(data_.GetAddress() + old_size, size_ - old_size);
+                size_ = old_size;
+                throw;
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        }
+    }
+
+    constexpr iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+        if (count == 0) {
+            return begin() + index;
+        }
+        // value может быть элементом вектора, который сдвинется при вставке
+        const T copy(value);
+        return InsertN(index, RepeatIterator{&copy, 0}, count);
+    }
+
+    constexpr iterator Insert(const_iterator pos, std::initializer_list<T> init) {
+        return Insert(pos, init.begin(), init.end());
+    }
+
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr void Append(InputIt first, InputIt last) {
+        Insert(end(), first, last);
+    }
+
+    constexpr void Append(std::initializer_list<T> init) {
+        Insert(end(), init.begin(), init.end());
+    }
+
+    // Заменяет содержимое диапазоном; существующие элементы переиспользуются присваиванием.
+    // Если диапазон не помещается в вместимость, новый буфер строится до уничтожения старого
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr void Assign(InputIt first, InputIt last) {
+        if constexpr (kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            if (count > Capacity()) {
+                Memory new_data(count, data_.GetAllocator());
+                NoteAllocation(new_data.Capacity());
+                UninitializedCopyN(first, count, new_data.GetAddress());
+                DestroyN(data_.GetAddress(), size_);
+                data_.Swap(new_data);
+            } else if (count >= size_) {
+                InputIt mid = std::next(first, size_);
+                std::copy(first, mid, begin());
+                UninitializedCopyN(mid, count - size_, end());
+            } else {
+                std::copy(first, last, begin());
+                DestroyN(data_ + count, size_ - count);
+            }
+            size_ = count;
+        } else {
+            DestroyN(data_.GetAddress(), size_);
+            size_ = 0;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    constexpr void Assign(std::initializer_list<T> init) {
+        Assign(init.begin(), init.end());
+    }
+
+    // Параллельный вариант копирующего присваивания с теми же гарантиями, что у operator=
+    template <typename Executor, typename = RequireParallelExecutor<Executor>>
+    void Assign(const Vector& rhs, Executor& executor) {
+        if (this == &rhs) {
+            return;
+        }
+
+        if (rhs.size_ > Capacity() || (kPropagateOnCopy && !kAlwaysEqual && GetAllocator() != rhs.GetAllocator())) {
+            Vector rhs_temp(rhs, kPropagateOnCopy ? rhs.GetAllocator() : GetAllocator(), executor, stats_);
+            rhs_temp.stats_ = Stats::DetachedSite();
+            Clear(executor);
+            if constexpr (kPropagateOnCopy && !kAlwaysEqual) {
+                data_ = std::move(rhs_temp.data_);
+            } else {
+                data_.Swap(rhs_temp.data_);
+            }
+            size_ = std::exchange(rhs_temp.size_, 0);
             return;
         }
 
-        RawMemory<T> new_data(capacity);
-        
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+        const T* from = rhs.data_.GetAddress();
+        T* to = data_.GetAddress();
+        const size_t common = std::min(size_, rhs.size_);
+        ForEachChunk(executor, to, common, [from, to](size_t first, size_t count) {
+            std::copy_n(from + first, count, to + first);
+        });
+        if (rhs.size_ >= size_) {
+            ParallelConstructN(executor, to + size_, rhs.size_ - size_, [this, from](T* elem, size_t first, size_t count) {
+                UninitializedCopyN(from + size_ + first, count, elem);
+            });
         } else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+            ParallelDestroyN(executor, to + rhs.size_, size_ - rhs.size_);
+        }
+        size_ = rhs.size_;
+    }
+
+    // Уничтожает все элементы; вместимость меняет только политика Shrink
+    constexpr void Clear() noexcept {
+        const size_t used = size_;
+        DestroyN(data_.GetAddress(), size_);
+        size_ = 0;
+        NoteShrink(used);
+    }
+
+    // Параллельный вариант Clear
+    template <typename Executor, typename = RequireParallelExecutor<Executor>>
+    void Clear(Executor& executor) {
+        const size_t used = size_;
+        ParallelDestroyN(executor, data_.GetAddress(), size_);
+        size_ = 0;
+        NoteShrink(used);
+    }
+
+    // Уменьшает вместимость до размера. При исключении вектор не меняется, как в Reserve
+    constexpr void ShrinkToFit() {
+        ShrinkTo(size_);
+    }
+
+    // Возвращает системе целые страницы буфера за концом вектора через madvise(MADV_DONTNEED),
+    // не меняя вместимости; следующая запись в них получит обнулённые страницы.
+    // Подходит для приватной анонимной памяти (std::allocator, MmapAllocator). Возвращает
+    // число освобождённых байт; там, где madvise недоступен, ничего не делает
+    size_t ReleaseUnusedPages() noexcept {
+#if defined(__linux__)
+        static const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const uintptr_t first = (reinterpret_cast<uintptr_t>(data_ + size_) + page_size - 1) & ~(page_size - 1);
+        const uintptr_t last = reinterpret_cast<uintptr_t>(data_ + Capacity()) & ~(page_size - 1);
+        if (data_.GetAddress() == nullptr || first >= last
+            || madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED) != 0) {
+            return 0;
         }
+        return last - first;
+#else
+        return 0;
+#endif
+    }
 
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+    constexpr void Reserve(size_t capacity){
+        if(capacity <= data_.Capacity()){
+            return;
+        }
+
+        const size_t old_capacity = data_.Capacity();
+        if constexpr (kIsTriviallyRelocatable<T> && Memory::kCanReallocate) {
+            data_.Reallocate(capacity);
+        } else {
+            Memory new_data(capacity, data_.GetAllocator());
+
+            RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+
+            data_.Swap(new_data);
+        }
+        NoteAllocation(data_.Capacity());
+        NoteGrowth(old_capacity, size_);
     }
 
 
-    size_t Capacity(){
+    constexpr size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    void Resize(size_t new_size){
+    constexpr void Resize(size_t new_size){
         if(size_ > new_size){
-            DestroyN(data_+new_size, size_ - new_size);  
+            DestroyN(data_+new_size, size_ - new_size);
+            size_ = new_size;
+            NoteShrink(new_size);
+            return;
         } else{
             if(new_size > Capacity()){
                 Reserve(new_size);
-                std::uninitialized_default_construct_n(data_ + size_, new_size - size_);
-            } else{ 
-                std::uninitialized_default_construct_n(data_ + size_, new_size - size_);
             }
+            UninitializedValueConstructN(data_ + size_, new_size - size_);
         }
         size_ = new_size;
     };
 
-    void PushBack(const T& value){
+    // Как Resize, но новые элементы инициализируются по умолчанию: для тривиальных типов
+    // память не заполняется вовсе
+    constexpr void ResizeDefaultInit(size_t new_size){
+        if(size_ > new_size){
+            DestroyN(data_+new_size, size_ - new_size);
+            size_ = new_size;
+            NoteShrink(new_size);
+            return;
+        } else{
+            if(new_size > Capacity()){
+                Reserve(new_size);
+            }
+            UninitializedDefaultConstructN(data_ + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Запись напрямую в память за концом вектора с последующей публикацией:
+    //
+    //     char* buf = v.AppendUninitialized(4096);
+    //     ssize_t n = read(fd, buf, 4096);
+    //     v.CommitAppend(n > 0 ? n : 0);
+    //
+    // AppendUninitialized гарантирует место под n элементов (с учётом политики роста)
+    // и возвращает указатель на первое из них; размер вектора не меняется.
+    // CommitAppend(k) с k не больше зарезервированного делает записанные элементы частью вектора.
+    // Доступно только для типов, которым не нужна инициализация
+    constexpr T* AppendUninitialized(size_t n){
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "AppendUninitialized requires a trivial element type");
+        if(n > Capacity() - size_){
+            const size_t next = NextCapacity();
+            Reserve(next > size_ + n ? next : size_ + n);
+        }
+        return data_.GetAddress() + size_;
+    }
+
+    constexpr void CommitAppend(size_t n) noexcept {
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "CommitAppend requires a trivial element type");
+        assert(n <= Capacity() - size_);
+        size_ += n;
+    }
+
+    constexpr void PushBack(const T& value){
        EmplaceBack(value);
     }
-    void PushBack(T&& value){
+    constexpr void PushBack(T&& value){
         EmplaceBack(std::move(value));
     }
-    void PopBack(){
+    constexpr void PopBack(){
         assert(size_ != 0);
 
         Destroy(data_+size_-1);
         --size_;
+        RecordShrink(size_);
     };
 
     template <typename... Args>
-T& EmplaceBack(Args&&... args) {
-    T* result = nullptr;
-
+constexpr T& EmplaceBack(Args&&... args) {
     if (size_ == Capacity()) {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+        return *GrowAndEmplace(size_, NextCapacity(), std::forward<Args>(args)...);
+    }
+
+    T* result = data_ + size_;
+    Construct(result, std::forward<Args>(args)...);
+    ++size_;
+    return *result;
+}
+
+
+private:
+    using Site = typename Stats::Site;
+
+    // Конструкторы с готовым местом статистики. Через них публичные конструкторы получают
+    // место из source_location, а временные векторы внутри методов — место самого вектора
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    constexpr Vector(InputIt first, InputIt last, const Alloc& alloc, Site site)
+        : data_(alloc)
+        , stats_(site) {
+        if constexpr (kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            Memory new_data(count, alloc);
+            NoteAllocation(new_data.Capacity());
+            UninitializedCopyN(first, count, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = count;
+        } else {
+            try {
+                for (; first != last; ++first) {
+                    EmplaceBack(*first);
+                }
+            } catch (...) {
+                DestroyN(data_.GetAddress(), size_);
+                throw;
+            }
+        }
+    }
 
-        result = new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+    constexpr Vector(const Vector& other, const Alloc& alloc, Site site)
+        : data_(other.size_, alloc)
+        , size_(other.size_)
+        , stats_(site) {
+        NoteAllocation(data_.Capacity());
+        UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+    }
+
+    template <typename Executor, typename = RequireParallelExecutor<Executor>>
+    Vector(const Vector& other, const Alloc& alloc, Executor& executor, Site site)
+        : data_(other.size_, alloc)
+        , size_(other.size_)
+        , stats_(site) {
+        NoteAllocation(data_.Capacity());
+        const T* from = other.data_.GetAddress();
+        ParallelConstructN(executor, data_.GetAddress(), size_, [this, from](T* to, size_t first, size_t count) {
+            UninitializedCopyN(from + first, count, to);
+        });
+    }
 
+    constexpr Vector(Vector&& other, const Alloc& alloc, Site site)
+        : data_(alloc)
+        , stats_(site) {
+        if (kAlwaysEqual || data_.GetAllocator() == other.GetAllocator()) {
+            data_.Swap(other.data_);
+            std::swap(size_, other.size_);
+        } else {
+            Memory new_data(other.size_, alloc);
+            NoteAllocation(new_data.Capacity());
+            UninitializedMoveIfNoexceptN(other.data_.GetAddress(), other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+        }
+    }
+
+    // Элементы создаются и уничтожаются через allocator_traits, чтобы
+    // аллокаторы вроде std::pmr::polymorphic_allocator могли передать себя вложенным объектам
+    template <typename... Args>
+    constexpr void Construct(T* buf, Args&&... args) {
+        AllocTraits::construct(data_.GetAllocator(), buf, std::forward<Args>(args)...);
+    }
+
+    constexpr void Destroy(T* elem) noexcept {
+        AllocTraits::destroy(data_.GetAllocator(), elem);
+    }
+
+    constexpr void DestroyN(T* elem, size_t n) noexcept {
+        for(size_t i = 0; i < n; i++){
+            Destroy(elem+i);
+        }
+    }
+
+    // Вызывает make(buf + i) для каждого из n элементов; если какой-то из них
+    // выбросит исключение, уже созданные элементы уничтожаются
+    template <typename MakeFn>
+    constexpr void UninitializedConstructN(T* buf, size_t n, MakeFn make) {
+        size_t constructed = 0;
         try {
+            for (; constructed < n; ++constructed) {
+                make(buf + constructed, constructed);
+            }
+        } catch (...) {
+            DestroyN(buf, constructed);
+            throw;
+        }
+    }
+
+    constexpr void UninitializedValueConstructN(T* buf, size_t n) {
+        UninitializedConstructN(buf, n, [this](T* elem, size_t) {
+            Construct(elem);
+        });
+    }
+
+    constexpr void UninitializedDefaultConstructN(T* buf, size_t n) {
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            UninitializedConstructN(buf, n, [this](T* elem, size_t) {
+                Construct(elem);
+            });
+        }
+    }
+
+    template <typename ForwardIt>
+    constexpr void UninitializedCopyN(ForwardIt from, size_t n, T* to) {
+        if constexpr (kIsBitwiseCopyable && (std::is_same_v<ForwardIt, const T*> || std::is_same_v<ForwardIt, T*>)) {
+            // memcpy недоступен при вычислении на этапе компиляции
+            if (!std::is_constant_evaluated()) {
+                if (n != 0) {
+                    std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+                }
+                return;
+            }
+        }
+        UninitializedConstructN(to, n, [this, &from](T* elem, size_t) {
+            Construct(elem, *from);
+            ++from;
+        });
+    }
+
+    // Перемещает элементы, если перемещение не бросает исключений (или копирование невозможно),
+    // иначе копирует: так при исключении исходные элементы остаются нетронутыми
+    constexpr void UninitializedMoveIfNoexceptN(T* from, size_t n, T* to) {
+        UninitializedConstructN(to, n, [this, from](T* elem, size_t i) {
             if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+                Construct(elem, std::move(from[i]));
             } else {
-                std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+                Construct(elem, from[i]);
             }
+        });
+    }
+
+    // Переносит n элементов в неинициализированную память to. Исходные элементы
+    // уничтожаются только после успешного переноса всех, что даёт строгую гарантию
+    constexpr void RelocateN(T* from, size_t n, T* to) {
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            MoveBytes(from, n, to);
+        } else {
+            UninitializedMoveIfNoexceptN(from, n, to);
+            DestroyN(from, n);
+        }
+    }
+
+    static constexpr void MoveBytes(T* from, size_t n, T* to) noexcept {
+        if (n == 0) {
+            return;
+        }
+        if (!std::is_constant_evaluated()) {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            return;
+        }
+        // На этапе компиляции побайтовый перенос заменяется перемещением с уничтожением источника.
+        // Указатели из разных буферов там нельзя сравнивать на <, поэтому направление обхода
+        // определяется поиском to внутри [from, from + n)
+        bool backward = false;
+        for (size_t i = 1; i < n && !backward; ++i) {
+            backward = from + i == to;
+        }
+        for (size_t k = 0; k < n; ++k) {
+            const size_t i = backward ? n - 1 - k : k;
+            std::construct_at(to + i, std::move(from[i]));
+            std::destroy_at(from + i);
+        }
+    }
+
+    // Неинициализированное место под один элемент, пригодное и для вычислений на этапе компиляции
+    union Slot {
+        constexpr Slot() noexcept {
+        }
+        constexpr ~Slot() {
+        }
+
+        T value;
+    };
+
+    // Прямой итератор, n раз выдающий один и тот же объект
+    struct RepeatIterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        constexpr const T& operator*() const noexcept {
+            return *value;
+        }
+        constexpr RepeatIterator& operator++() noexcept {
+            ++position;
+            return *this;
+        }
+        constexpr RepeatIterator operator++(int) noexcept {
+            RepeatIterator old = *this;
+            ++position;
+            return old;
+        }
+        constexpr bool operator==(const RepeatIterator& other) const noexcept {
+            return position == other.position;
+        }
+        constexpr bool operator!=(const RepeatIterator& other) const noexcept {
+            return position != other.position;
+        }
+
+        const T* value;
+        size_t position;
+    };
+
+    constexpr bool Overlaps(const T* first, size_t count) const noexcept {
+        if (std::is_constant_evaluated()) {
+            // Там сравнимы на < только указатели в один массив: ищем first среди своих элементов
+            for (const T* elem = begin(); elem != end(); ++elem) {
+                if (elem == first) {
+                    return true;
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (first + i == begin()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        const std::less<const T*> less;
+        return less(first, end()) && less(begin(), first + count);
+    }
+
+    // Вставляет count элементов, построенных из *first, *(first + 1), ..., в позицию index
+    template <typename ForwardIt>
+    constexpr iterator InsertN(size_t index, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return begin() + index;
+        }
+
+        if (count > Capacity() - size_) {
+            const size_t next = NextCapacity();
+            Memory new_data(next > size_ + count ? next : size_ + count, data_.GetAllocator());
+            NoteAllocation(new_data.Capacity());
+            T* new_ptr = new_data.GetAddress();
+            T* ptr = data_.GetAddress();
+
+            UninitializedCopyN(first, count, new_ptr + index);
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                MoveBytes(ptr, index, new_ptr);
+                MoveBytes(ptr + index, size_ - index, new_ptr + index + count);
+            } else {
+                try {
+                    UninitializedMoveIfNoexceptN(ptr, index, new_ptr);
+                } catch (...) {
+                    DestroyN(new_ptr + index, count);
+                    throw;
+                }
+                try {
+                    UninitializedMoveIfNoexceptN(ptr + index, size_ - index, new_ptr + index + count);
+                } catch (...) {
+                    DestroyN(new_ptr, index + count);
+                    throw;
+                }
+                DestroyN(ptr, size_);
+            }
+            const size_t old_capacity = data_.Capacity();
+            data_.Swap(new_data);
+            NoteGrowth(old_capacity, size_);
+            size_ += count;
+            return begin() + index;
+        }
+
+        T* pos = data_.GetAddress() + index;
+        T* old_end = data_.GetAddress() + size_;
+        const size_t elems_after = size_ - index;
+
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            // Хвост отодвигается побайтово, а при исключении возвращается на место
+            MoveBytes(pos, elems_after, pos + count);
+            try {
+                UninitializedCopyN(first, count, pos);
+            } catch (...) {
+                MoveBytes(pos + count, elems_after, pos);
+                throw;
+            }
+            size_ += count;
+        } else if (elems_after > count) {
+            T* tail = old_end - count;
+            UninitializedConstructN(old_end, count, [this, tail](T* elem, size_t i) {
+                Construct(elem, std::move(tail[i]));
+            });
+            size_ += count;
+            std::move_backward(pos, old_end - count, old_end);
+            std::copy_n(first, count, pos);
+        } else {
+            ForwardIt mid = std::next(first, elems_after);
+            UninitializedCopyN(mid, count - elems_after, old_end);
+            try {
+                UninitializedConstructN(pos + count, elems_after, [this, pos](T* elem, size_t i) {
+                    Construct(elem, std::move(pos[i]));
+                });
+            } catch (...) {
+                DestroyN(old_end, count - elems_after);
+                throw;
+            }
+            size_ += count;
+            std::copy(first, mid, pos);
+        }
+        return begin() + index;
+    }
+
+    // Граница chunk-го из chunks кусков массива buf из n элементов: первый элемент, который
+    // начинается не раньше ближайшей кеш-линии. Так соседние куски не пишут в одну линию
+    // (кроме элемента, пересекающего границу линии, если sizeof(T) не делит её размер)
+    static size_t ChunkBoundary(const T* buf, size_t n, size_t chunks, size_t chunk) noexcept {
+        if (chunk == 0) {
+            return 0;
+        }
+        if (chunk >= chunks) {
+            return n;
+        }
+        const uintptr_t base = reinterpret_cast<uintptr_t>(buf);
+        const uintptr_t split = base + n / chunks * chunk * sizeof(T);
+        const uintptr_t line = (split + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+        const size_t index = (line - base + sizeof(T) - 1) / sizeof(T);
+        return index < n ? index : n;
+    }
+
+    template <typename Executor>
+    static size_t ParallelChunkCount(const Executor& executor, size_t n) noexcept {
+        const size_t by_size = n * sizeof(T) / kParallelMinChunkBytes;
+        // Несколько кусков на поток сглаживают разницу в скорости потоков
+        const size_t by_threads = executor.Concurrency() * 4;
+        return executor.Concurrency() <= 1 ? 1 : std::min(by_size, by_threads);
+    }
+
+    // Вызывает body(first, count) для каждого куска [0, n), куски обрабатываются параллельно
+    template <typename Executor, typename Body>
+    static void ForEachChunk(Executor& executor, const T* buf, size_t n, Body body) {
+        const size_t chunks = ParallelChunkCount(executor, n);
+        if (chunks <= 1) {
+            body(0, n);
+            return;
+        }
+        executor.ParallelFor(chunks, [&](size_t chunk) {
+            const size_t first = ChunkBoundary(buf, n, chunks, chunk);
+            body(first, ChunkBoundary(buf, n, chunks, chunk + 1) - first);
+        });
+    }
+
+    // Параллельный UninitializedConstructN: construct(buf + first, first, count) создаёт
+    // элементы куска и при исключении сам уничтожает созданные им. Если выбросил какой-то
+    // кусок, уничтожаются и все завершённые куски
+    template <typename Executor, typename ConstructRange>
+    void ParallelConstructN(Executor& executor, T* buf, size_t n, ConstructRange construct) {
+        const size_t chunks = ParallelChunkCount(executor, n);
+        if (chunks <= 1) {
+            construct(buf, 0, n);
+            return;
+        }
+        std::unique_ptr<bool[]> done(new bool[chunks]());
+        try {
+            executor.ParallelFor(chunks, [&](size_t chunk) {
+                const size_t first = ChunkBoundary(buf, n, chunks, chunk);
+                construct(buf + first, first, ChunkBoundary(buf, n, chunks, chunk + 1) - first);
+                done[chunk] = true;
+            });
         } catch (...) {
-            std::destroy_at(new_data.GetAddress() + size_);
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                if (done[chunk]) {
+                    const size_t first = ChunkBoundary(buf, n, chunks, chunk);
+                    DestroyN(buf + first, ChunkBoundary(buf, n, chunks, chunk + 1) - first);
+                }
+            }
             throw;
         }
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+    }
+
+    template <typename Executor>
+    void ParallelDestroyN(Executor& executor, T* buf, size_t n) {
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            DestroyN(buf, n);
+        } else {
+            ForEachChunk(executor, buf, n, [this, buf](size_t first, size_t count) {
+                DestroyN(buf + first, count);
+            });
+        }
+    }
 
-    } else {
-        result = new (data_ + size_) T(std::forward<Args>(args)...);
+    // Поэлементные выражения не переносят зависимостей между итерациями, даже если
+    // читают out: элемент i зависит только от элементов i операндов. GCC 12 векторизует
+    // этот цикл с -O3 (или -O2 -fvect-cost-model=dynamic); при обычном -O2 его модель
+    // стоимости пропускает цикл, и он остаётся скалярным. Ширину векторов задаёт -march
+    template <typename Expr>
+    static constexpr void EvaluateInto(T* out, const Expr& expr) {
+        static_assert(std::is_arithmetic_v<T>, "Vector expressions require an arithmetic element type");
+        const size_t count = expr.Size();
+#pragma GCC ivdep
+        for (size_t i = 0; i < count; ++i) {
+            std::construct_at(out + i, static_cast<T>(expr[i]));
+        }
     }
 
-    ++size_;
-    return *result;
-}
+    constexpr void NoteAllocation(size_t capacity) noexcept {
+        if (capacity != 0) {
+            Stats::OnAllocate(stats_, capacity * sizeof(T));
+        }
+    }
 
+    static constexpr bool kRelocatesByCopy = !kIsTriviallyRelocatable<T> && !std::is_nothrow_move_constructible_v<T>
+                                             && std::is_copy_constructible_v<T>;
 
-private:
-    static void CopyConstruct(T* buf, const T& elem) {
-        new (buf) T(elem);
+    // Вызывается после переезда relocated элементов в буфер текущей вместимости
+    constexpr void NoteGrowth(size_t old_capacity, size_t relocated) noexcept {
+        Stats::OnGrow(stats_, old_capacity, Capacity());
+        Stats::OnRelocate(stats_, kRelocatesByCopy ? 0 : relocated, kRelocatesByCopy ? relocated : 0);
+        shrink_ = {};
+    }
+
+    // Переезд в буфер меньшей вместимости; при capacity == 0 буфер просто освобождается
+    constexpr void ShrinkTo(size_t capacity) {
+        assert(capacity >= size_);
+        if (capacity >= Capacity()) {
+            return;
+        }
+        if (capacity == 0) {
+            Memory empty(data_.GetAllocator());
+            data_.Swap(empty);
+            return;
+        }
+        if constexpr (kIsTriviallyRelocatable<T> && Memory::kCanReallocate) {
+            data_.Reallocate(capacity);
+        } else {
+            Memory new_data(capacity, data_.GetAllocator());
+            RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+            data_.Swap(new_data);
+        }
+        NoteAllocation(data_.Capacity());
+        Stats::OnRelocate(stats_, kRelocatesByCopy ? 0 : size_, kRelocatesByCopy ? size_ : 0);
     }
 
-    void Destroy(T* elem){
-        elem->~T();
+    // Спрашивает политику Shrink, не пора ли вернуть память. Автоматическое сжатие —
+    // только оптимизация: оно не копирует элементы, а нехватка памяти оставляет буфер прежним
+    constexpr void NoteShrink(size_t used) noexcept {
+        if constexpr (!std::is_same_v<Shrink, NoShrink>) {
+            const size_t target = Shrink::OnShrink(shrink_, used, Capacity(), sizeof(T));
+            if (target >= Capacity()) {
+                return;
+            }
+            shrink_ = {};
+            if (Capacity() * sizeof(T) >= Shrink::kReleasePagesBytes) {
+                ReleaseUnusedPages();
+            } else if constexpr (!kRelocatesByCopy) {
+                try {
+                    ShrinkTo(std::max(target, size_));
+                } catch (...) {
+                }
+            }
+        }
     }
 
-    void DestroyN(T* elem, size_t n){
-        for(size_t i = 0; i < n; i++){
-            Destroy(elem+i);
+    // Сообщает политике Shrink занятость после удаления, не перевыделяя память:
+    // просьба ужать буфер остаётся в State до следующего NoteShrink
+    constexpr void RecordShrink(size_t used) noexcept {
+        if constexpr (!std::is_same_v<Shrink, NoShrink>) {
+            Shrink::OnShrink(shrink_, used, Capacity(), sizeof(T));
         }
     }
 
-    RawMemory<T> data_;
+    constexpr size_t NextCapacity() const noexcept {
+        const size_t next = Growth::NextCapacity(Capacity(), sizeof(T));
+        return next > size_ ? next : size_ + 1;
+    }
+
+    // Переезд в буфер вместимостью new_capacity со вставкой нового элемента в позицию index
+    template <typename... Args>
+    constexpr T* GrowAndEmplace(size_t index, size_t new_capacity, Args&&... args) {
+        T* ptr = data_.GetAddress();
+
+        if constexpr (kIsTriviallyRelocatable<T> && Memory::kCanReallocate) {
+            // args могут ссылаться на элементы вектора, а reallocate освобождает старый буфер,
+            // поэтому новый элемент сначала создаётся во временном хранилище
+            Slot slot;
+            T* temp = &slot.value;
+            Construct(temp, std::forward<Args>(args)...);
+            const size_t old_capacity = data_.Capacity();
+            try {
+                data_.Reallocate(new_capacity);
+            } catch (...) {
+                Destroy(temp);
+                throw;
+            }
+            NoteAllocation(data_.Capacity());
+            NoteGrowth(old_capacity, size_);
+            ptr = data_.GetAddress();
+            MoveBytes(ptr + index, size_ - index, ptr + index + 1);
+            MoveBytes(temp, 1, ptr + index);
+            ++size_;
+            return ptr + index;
+        } else {
+            Memory new_data(new_capacity, data_.GetAllocator());
+            NoteAllocation(new_data.Capacity());
+            T* new_ptr = new_data.GetAddress() + index;
+
+            Construct(new_ptr, std::forward<Args>(args)...);
+
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                MoveBytes(ptr, index, new_data.GetAddress());
+                MoveBytes(ptr + index, size_ - index, new_ptr + 1);
+            } else {
+                try {
+                    UninitializedMoveIfNoexceptN(ptr, index, new_data.GetAddress());
+                } catch (...) {
+                    Destroy(new_ptr);
+                    throw;
+                }
+
+                try {
+                    UninitializedMoveIfNoexceptN(ptr + index, size_ - index, new_ptr + 1);
+                } catch (...) {
+                    DestroyN(new_data.GetAddress(), index + 1);
+                    throw;
+                }
+
+                DestroyN(ptr, size_);
+            }
+            const size_t old_capacity = data_.Capacity();
+            data_.Swap(new_data);
+            NoteGrowth(old_capacity, size_);
+            ++size_;
+            return new_ptr;
+        }
+    }
+
+    Memory data_;
     size_t size_ = 0;
+    [[no_unique_address]] typename Stats::Site stats_;
+    [[no_unique_address]] typename Shrink::State shrink_;
 };
+
+namespace pmr {
+
+template <typename T>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
@@ -0,0 +1,817 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_ALGORITHMS_X86 1
+#endif
+
+// Алгоритмы поиска и свёртки для Vector<int32_t> и Vector<float> на SIMD-ядрах
+// (SSE2, AVX2, AVX-512). Набор инструкций выбирается во время выполнения по возможностям
+// процессора; его можно понизить явно, передав SimdLevel. Для прочих типов элементов
+// используются обычные скалярные циклы.
+//
+// Для float ядра не делают предположений о NaN: при их наличии результат MinMax
+// не определён, а Sum и Dot складывают элементы в порядке, одинаковом во всех версиях,
+// поэтому их результаты совпадают побитово.
+
+enum class SimdLevel {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kAvx512,
+};
+
+enum class CompareOp {
+    kEqual,
+    kNotEqual,
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+};
+
+template <CompareOp Op, typename T>
+bool Compare(const T& lhs, const T& rhs) {
+    if constexpr (Op == CompareOp::kEqual) {
+        return lhs == rhs;
+    } else if constexpr (Op == CompareOp::kNotEqual) {
+        return lhs != rhs;
+    } else if constexpr (Op == CompareOp::kLess) {
+        return lhs < rhs;
+    } else if constexpr (Op == CompareOp::kLessEqual) {
+        return lhs <= rhs;
+    } else if constexpr (Op == CompareOp::kGreater) {
+        return lhs > rhs;
+    } else {
+        return lhs >= rhs;
+    }
+}
+
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(VECTOR_ALGORITHMS_X86)
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::kAvx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::kAvx2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return SimdLevel::kSse2;
+        }
+        return SimdLevel::kScalar;
+    }();
+    return level;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+// Тип результата Sum и Dot: целые суммируются в int64_t без переполнения на 32 битах
+template <typename T>
+using SumType = std::conditional_t<std::is_integral_v<T>, int64_t, T>;
+
+template <typename T>
+inline constexpr bool kHasSimdKernels = std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+// Сжатие a * b + c в fma зависит от набора инструкций и изменило бы результат Dot
+// для float, поэтому ядра компилируются без него
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+namespace simd_scalar {
+
+template <typename Element>
+struct ScalarTraits {
+    using T = Element;
+    using Reg = T;
+    using Sum = SumType<T>;
+    static constexpr size_t kLanes = 1;
+
+    struct Acc {
+        Sum lanes[16];
+    };
+
+    static Reg Load(const T* p) {
+        return *p;
+    }
+    static void Store(T* p, Reg v) {
+        *p = v;
+    }
+    static Reg Broadcast(T value) {
+        return value;
+    }
+    static Reg Min(Reg a, Reg b) {
+        return a < b ? a : b;
+    }
+    static Reg Max(Reg a, Reg b) {
+        return a > b ? a : b;
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        return Compare<Op>(a, b) ? 1 : 0;
+    }
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        *out = v;
+        return mask;
+    }
+    static Acc Zero() {
+        return {};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        for (size_t j = 0; j < 16; ++j) {
+            acc.lanes[j] += static_cast<Sum>(p[j]);
+        }
+    }
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        for (size_t j = 0; j < 16; ++j) {
+            acc.lanes[j] += static_cast<Sum>(a[j]) * static_cast<Sum>(b[j]);
+        }
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        std::copy_n(acc.lanes, 16, out);
+    }
+};
+
+template <typename T>
+using TraitsFor = ScalarTraits<T>;
+
+#include "vector_algorithms_kernels.inc"
+
+}  // namespace simd_scalar
+
+#if defined(VECTOR_ALGORITHMS_X86)
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+namespace simd_sse2 {
+
+struct I32 {
+    using T = int32_t;
+    using Reg = __m128i;
+    using Sum = int64_t;
+    static constexpr size_t kLanes = 4;
+
+    struct Acc {
+        __m128i lanes[2];
+    };
+
+    static Reg Load(const T* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+    static void Store(T* p, Reg v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+    }
+    static Reg Broadcast(T value) {
+        return _mm_set1_epi32(value);
+    }
+    // В SSE2 нет pminsd/pmaxsd, поэтому выбор делается маской сравнения
+    static Reg Min(Reg a, Reg b) {
+        const __m128i a_greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(a_greater, b), _mm_andnot_si128(a_greater, a));
+    }
+    static Reg Max(Reg a, Reg b) {
+        const __m128i a_greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(a_greater, a), _mm_andnot_si128(a_greater, b));
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        constexpr uint32_t kAll = 0xF;
+        if constexpr (Op == CompareOp::kEqual) {
+            return Bits(_mm_cmpeq_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kNotEqual) {
+            return kAll ^ Bits(_mm_cmpeq_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kLess) {
+            return Bits(_mm_cmplt_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kLessEqual) {
+            return kAll ^ Bits(_mm_cmpgt_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kGreater) {
+            return Bits(_mm_cmpgt_epi32(a, b));
+        } else {
+            return kAll ^ Bits(_mm_cmplt_epi32(a, b));
+        }
+    }
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        return CompressByBits(out, v, mask);
+    }
+    static Acc Zero() {
+        return {{_mm_setzero_si128(), _mm_setzero_si128()}};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        for (size_t k = 0; k < 4; ++k) {
+            const __m128i v = Load(p + 4 * k);
+            const __m128i sign = _mm_srai_epi32(v, 31);
+            acc.lanes[0] = _mm_add_epi64(acc.lanes[0], _mm_unpacklo_epi32(v, sign));
+            acc.lanes[1] = _mm_add_epi64(acc.lanes[1], _mm_unpackhi_epi32(v, sign));
+        }
+    }
+    // Знакового умножения 32x32->64 в SSE2 нет
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        int64_t sum = 0;
+        for (size_t j = 0; j < 16; ++j) {
+            sum += static_cast<int64_t>(a[j]) * b[j];
+        }
+        acc.lanes[0] = _mm_add_epi64(acc.lanes[0], _mm_set_epi64x(0, sum));
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        std::fill_n(out, 16, 0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), acc.lanes[0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2), acc.lanes[1]);
+    }
+
+    static uint32_t Bits(__m128i mask) {
+        return _mm_movemask_ps(_mm_castsi128_ps(mask));
+    }
+    static size_t CompressByBits(T* out, Reg v, uint32_t mask) {
+        T values[kLanes];
+        Store(values, v);
+        size_t count = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            out[count++] = values[__builtin_ctz(mask)];
+        }
+        return count;
+    }
+};
+
+struct F32 {
+    using T = float;
+    using Reg = __m128;
+    using Sum = float;
+    static constexpr size_t kLanes = 4;
+
+    struct Acc {
+        __m128 lanes[4];
+    };
+
+    static Reg Load(const T* p) {
+        return _mm_loadu_ps(p);
+    }
+    static void Store(T* p, Reg v) {
+        _mm_storeu_ps(p, v);
+    }
+    static Reg Broadcast(T value) {
+        return _mm_set1_ps(value);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm_min_ps(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm_max_ps(a, b);
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        if constexpr (Op == CompareOp::kEqual) {
+            return _mm_movemask_ps(_mm_cmpeq_ps(a, b));
+        } else if constexpr (Op == CompareOp::kNotEqual) {
+            return _mm_movemask_ps(_mm_cmpneq_ps(a, b));
+        } else if constexpr (Op == CompareOp::kLess) {
+            return _mm_movemask_ps(_mm_cmplt_ps(a, b));
+        } else if constexpr (Op == CompareOp::kLessEqual) {
+            return _mm_movemask_ps(_mm_cmple_ps(a, b));
+        } else if constexpr (Op == CompareOp::kGreater) {
+            return _mm_movemask_ps(_mm_cmpgt_ps(a, b));
+        } else {
+            return _mm_movemask_ps(_mm_cmpge_ps(a, b));
+        }
+    }
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        T values[kLanes];
+        Store(values, v);
+        size_t count = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            out[count++] = values[__builtin_ctz(mask)];
+        }
+        return count;
+    }
+    static Acc Zero() {
+        return {{_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()}};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        for (size_t k = 0; k < 4; ++k) {
+            acc.lanes[k] = _mm_add_ps(acc.lanes[k], Load(p + 4 * k));
+        }
+    }
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        for (size_t k = 0; k < 4; ++k) {
+            acc.lanes[k] = _mm_add_ps(acc.lanes[k], _mm_mul_ps(Load(a + 4 * k), Load(b + 4 * k)));
+        }
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        for (size_t k = 0; k < 4; ++k) {
+            Store(out + 4 * k, acc.lanes[k]);
+        }
+    }
+};
+
+template <typename T>
+using TraitsFor = std::conditional_t<std::is_same_v<T, float>, F32, I32>;
+
+#include "vector_algorithms_kernels.inc"
+
+}  // namespace simd_sse2
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace simd_avx2 {
+
+// Перестановки для упаковки отобранных элементов: строка mask содержит индексы
+// установленных битов mask по возрастанию
+struct CompressTable {
+    constexpr CompressTable() {
+        for (uint32_t mask = 0; mask < 256; ++mask) {
+            uint32_t count = 0;
+            for (uint32_t lane = 0; lane < 8; ++lane) {
+                if (mask & (1u << lane)) {
+                    indices[mask][count++] = lane;
+                }
+            }
+            for (; count < 8; ++count) {
+                indices[mask][count] = 0;
+            }
+        }
+    }
+    uint32_t indices[256][8] = {};
+};
+
+inline constexpr CompressTable kCompressTable{};
+
+struct I32 {
+    using T = int32_t;
+    using Reg = __m256i;
+    using Sum = int64_t;
+    static constexpr size_t kLanes = 8;
+
+    struct Acc {
+        __m256i lanes[2];
+    };
+
+    static Reg Load(const T* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static void Store(T* p, Reg v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    static Reg Broadcast(T value) {
+        return _mm256_set1_epi32(value);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm256_min_epi32(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm256_max_epi32(a, b);
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        constexpr uint32_t kAll = 0xFF;
+        if constexpr (Op == CompareOp::kEqual) {
+            return Bits(_mm256_cmpeq_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kNotEqual) {
+            return kAll ^ Bits(_mm256_cmpeq_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kLess) {
+            return Bits(_mm256_cmpgt_epi32(b, a));
+        } else if constexpr (Op == CompareOp::kLessEqual) {
+            return kAll ^ Bits(_mm256_cmpgt_epi32(a, b));
+        } else if constexpr (Op == CompareOp::kGreater) {
+            return Bits(_mm256_cmpgt_epi32(a, b));
+        } else {
+            return kAll ^ Bits(_mm256_cmpgt_epi32(b, a));
+        }
+    }
+    // Записывает все 8 элементов, но лишние попадают в уже прочитанную часть буфера
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        const __m256i permutation = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(kCompressTable.indices[mask]));
+        Store(out, _mm256_permutevar8x32_epi32(v, permutation));
+        return __builtin_popcount(mask);
+    }
+    static Acc Zero() {
+        return {{_mm256_setzero_si256(), _mm256_setzero_si256()}};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        for (size_t k = 0; k < 2; ++k) {
+            const __m256i v = Load(p + 8 * k);
+            acc.lanes[0] = _mm256_add_epi64(acc.lanes[0], _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            acc.lanes[1] = _mm256_add_epi64(acc.lanes[1], _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+    }
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        for (size_t k = 0; k < 2; ++k) {
+            const __m256i va = Load(a + 8 * k);
+            const __m256i vb = Load(b + 8 * k);
+            const __m256i lo = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(va)),
+                                                _mm256_cvtepi32_epi64(_mm256_castsi256_si128(vb)));
+            const __m256i hi = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(va, 1)),
+                                                _mm256_cvtepi32_epi64(_mm256_extracti128_si256(vb, 1)));
+            acc.lanes[0] = _mm256_add_epi64(acc.lanes[0], lo);
+            acc.lanes[1] = _mm256_add_epi64(acc.lanes[1], hi);
+        }
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        std::fill_n(out, 16, 0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), acc.lanes[0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4), acc.lanes[1]);
+    }
+
+    static uint32_t Bits(__m256i mask) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+    }
+};
+
+struct F32 {
+    using T = float;
+    using Reg = __m256;
+    using Sum = float;
+    static constexpr size_t kLanes = 8;
+
+    struct Acc {
+        __m256 lanes[2];
+    };
+
+    static Reg Load(const T* p) {
+        return _mm256_loadu_ps(p);
+    }
+    static void Store(T* p, Reg v) {
+        _mm256_storeu_ps(p, v);
+    }
+    static Reg Broadcast(T value) {
+        return _mm256_set1_ps(value);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm256_min_ps(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm256_max_ps(a, b);
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        if constexpr (Op == CompareOp::kEqual) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+        } else if constexpr (Op == CompareOp::kNotEqual) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_NEQ_UQ));
+        } else if constexpr (Op == CompareOp::kLess) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ));
+        } else if constexpr (Op == CompareOp::kLessEqual) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ));
+        } else if constexpr (Op == CompareOp::kGreater) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ));
+        } else {
+            return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ));
+        }
+    }
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        const __m256i permutation = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(kCompressTable.indices[mask]));
+        Store(out, _mm256_permutevar8x32_ps(v, permutation));
+        return __builtin_popcount(mask);
+    }
+    static Acc Zero() {
+        return {{_mm256_setzero_ps(), _mm256_setzero_ps()}};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        acc.lanes[0] = _mm256_add_ps(acc.lanes[0], Load(p));
+        acc.lanes[1] = _mm256_add_ps(acc.lanes[1], Load(p + 8));
+    }
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        acc.lanes[0] = _mm256_add_ps(acc.lanes[0], _mm256_mul_ps(Load(a), Load(b)));
+        acc.lanes[1] = _mm256_add_ps(acc.lanes[1], _mm256_mul_ps(Load(a + 8), Load(b + 8)));
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        Store(out, acc.lanes[0]);
+        Store(out + 8, acc.lanes[1]);
+    }
+};
+
+template <typename T>
+using TraitsFor = std::conditional_t<std::is_same_v<T, float>, F32, I32>;
+
+#include "vector_algorithms_kernels.inc"
+
+}  // namespace simd_avx2
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// В GCC 12 маскированные интринсики AVX-512 дают ложное -Wmaybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace simd_avx512 {
+
+constexpr int IntPredicate(CompareOp op) {
+    switch (op) {
+    case CompareOp::kEqual:
+        return _MM_CMPINT_EQ;
+    case CompareOp::kNotEqual:
+        return _MM_CMPINT_NE;
+    case CompareOp::kLess:
+        return _MM_CMPINT_LT;
+    case CompareOp::kLessEqual:
+        return _MM_CMPINT_LE;
+    case CompareOp::kGreater:
+        return _MM_CMPINT_NLE;
+    default:
+        return _MM_CMPINT_NLT;
+    }
+}
+
+constexpr int FloatPredicate(CompareOp op) {
+    switch (op) {
+    case CompareOp::kEqual:
+        return _CMP_EQ_OQ;
+    case CompareOp::kNotEqual:
+        return _CMP_NEQ_UQ;
+    case CompareOp::kLess:
+        return _CMP_LT_OQ;
+    case CompareOp::kLessEqual:
+        return _CMP_LE_OQ;
+    case CompareOp::kGreater:
+        return _CMP_GT_OQ;
+    default:
+        return _CMP_GE_OQ;
+    }
+}
+
+struct I32 {
+    using T = int32_t;
+    using Reg = __m512i;
+    using Sum = int64_t;
+    static constexpr size_t kLanes = 16;
+
+    struct Acc {
+        __m512i lanes[2];
+    };
+
+    static Reg Load(const T* p) {
+        return _mm512_loadu_si512(p);
+    }
+    static void Store(T* p, Reg v) {
+        _mm512_storeu_si512(p, v);
+    }
+    static Reg Broadcast(T value) {
+        return _mm512_set1_epi32(value);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm512_min_epi32(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm512_max_epi32(a, b);
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        constexpr int kPredicate = IntPredicate(Op);
+        return _mm512_cmp_epi32_mask(a, b, kPredicate);
+    }
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        _mm512_mask_compressstoreu_epi32(out, static_cast<__mmask16>(mask), v);
+        return __builtin_popcount(mask);
+    }
+    static Acc Zero() {
+        return {{_mm512_setzero_si512(), _mm512_setzero_si512()}};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        const __m512i v = Load(p);
+        acc.lanes[0] = _mm512_add_epi64(acc.lanes[0], _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        acc.lanes[1] = _mm512_add_epi64(acc.lanes[1], _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        const __m512i va = Load(a);
+        const __m512i vb = Load(b);
+        const __m512i lo = _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm512_castsi512_si256(va)),
+                                            _mm512_cvtepi32_epi64(_mm512_castsi512_si256(vb)));
+        const __m512i hi = _mm512_mul_epi32(_mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(va, 1)),
+                                            _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(vb, 1)));
+        acc.lanes[0] = _mm512_add_epi64(acc.lanes[0], lo);
+        acc.lanes[1] = _mm512_add_epi64(acc.lanes[1], hi);
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        _mm512_storeu_si512(out, acc.lanes[0]);
+        _mm512_storeu_si512(out + 8, acc.lanes[1]);
+    }
+};
+
+struct F32 {
+    using T = float;
+    using Reg = __m512;
+    using Sum = float;
+    static constexpr size_t kLanes = 16;
+
+    struct Acc {
+        __m512 lanes;
+    };
+
+    static Reg Load(const T* p) {
+        return _mm512_loadu_ps(p);
+    }
+    static void Store(T* p, Reg v) {
+        _mm512_storeu_ps(p, v);
+    }
+    static Reg Broadcast(T value) {
+        return _mm512_set1_ps(value);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm512_min_ps(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm512_max_ps(a, b);
+    }
+    template <CompareOp Op>
+    static uint32_t CompareMask(Reg a, Reg b) {
+        constexpr int kPredicate = FloatPredicate(Op);
+        return _mm512_cmp_ps_mask(a, b, kPredicate);
+    }
+    static size_t CompressStore(T* out, Reg v, uint32_t mask) {
+        _mm512_mask_compressstoreu_ps(out, static_cast<__mmask16>(mask), v);
+        return __builtin_popcount(mask);
+    }
+    static Acc Zero() {
+        return {_mm512_setzero_ps()};
+    }
+    static void Add16(Acc& acc, const T* p) {
+        acc.lanes = _mm512_add_ps(acc.lanes, Load(p));
+    }
+    static void MulAdd16(Acc& acc, const T* a, const T* b) {
+        acc.lanes = _mm512_add_ps(acc.lanes, _mm512_mul_ps(Load(a), Load(b)));
+    }
+    static void Spill(const Acc& acc, Sum* out) {
+        Store(out, acc.lanes);
+    }
+};
+
+template <typename T>
+using TraitsFor = std::conditional_t<std::is_same_v<T, float>, F32, I32>;
+
+#include "vector_algorithms_kernels.inc"
+
+}  // namespace simd_avx512
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+#endif  // VECTOR_ALGORITHMS_X86
+
+#pragma GCC pop_options
+
+// Вызывает fn(Kernels) с ядрами выбранного набора инструкций; уровень выше
+// поддерживаемого процессором понижается до доступного
+template <typename T, typename Fn>
+decltype(auto) DispatchSimd(SimdLevel level, Fn&& fn) {
+    static_assert(kHasSimdKernels<T>);
+    level = std::min(level, DetectSimdLevel());
+#if defined(VECTOR_ALGORITHMS_X86)
+    switch (level) {
+    case SimdLevel::kAvx512:
+        return fn(simd_avx512::Kernels<simd_avx512::TraitsFor<T>>{});
+    case SimdLevel::kAvx2:
+        return fn(simd_avx2::Kernels<simd_avx2::TraitsFor<T>>{});
+    case SimdLevel::kSse2:
+        return fn(simd_sse2::Kernels<simd_sse2::TraitsFor<T>>{});
+    default:
+        break;
+    }
+#endif
+    return fn(simd_scalar::Kernels<simd_scalar::TraitsFor<T>>{});
+}
+
+// Первый элемент, равный value, или end()
+template <typename T, typename... Params>
+const T* Find(const Vector<T, Params...>& v, const T& value, SimdLevel level = DetectSimdLevel()) {
+    if constexpr (kHasSimdKernels<T>) {
+        return v.begin() + DispatchSimd<T>(level, [&](auto kernels) {
+            return decltype(kernels)::Find(v.begin(), v.Size(), value);
+        });
+    } else {
+        return std::find(v.begin(), v.end(), value);
+    }
+}
+
+template <typename T, typename... Params>
+size_t Count(const Vector<T, Params...>& v, const T& value, SimdLevel level = DetectSimdLevel()) {
+    if constexpr (kHasSimdKernels<T>) {
+        return DispatchSimd<T>(level, [&](auto kernels) {
+            return decltype(kernels)::Count(v.begin(), v.Size(), value);
+        });
+    } else {
+        return std::count(v.begin(), v.end(), value);
+    }
+}
+
+template <typename T, typename... Params>
+bool Contains(const Vector<T, Params...>& v, const T& value, SimdLevel level = DetectSimdLevel()) {
+    return Find(v, value, level) != v.end();
+}
+
+// Наименьший и наибольший элементы непустого вектора
+template <typename T, typename... Params>
+std::pair<T, T> MinMax(const Vector<T, Params...>& v, SimdLevel level = DetectSimdLevel()) {
+    assert(v.Size() != 0);
+    if constexpr (kHasSimdKernels<T>) {
+        return DispatchSimd<T>(level, [&](auto kernels) {
+            return decltype(kernels)::MinMax(v.begin(), v.Size());
+        });
+    } else {
+        const auto [min, max] = std::minmax_element(v.begin(), v.end());
+        return {*min, *max};
+    }
+}
+
+template <typename T, typename... Params>
+SumType<T> Sum(const Vector<T, Params...>& v, SimdLevel level = DetectSimdLevel()) {
+    if constexpr (kHasSimdKernels<T>) {
+        return DispatchSimd<T>(level, [&](auto kernels) {
+            return decltype(kernels)::Total(v.begin(), v.Size());
+        });
+    } else {
+        SumType<T> sum{};
+        for (const T& value : v) {
+            sum += value;
+        }
+        return sum;
+    }
+}
+
+// Скалярное произведение векторов одинакового размера
+template <typename T, typename... Params>
+SumType<T> Dot(const Vector<T, Params...>& lhs, const Vector<T, Params...>& rhs,
+               SimdLevel level = DetectSimdLevel()) {
+    assert(lhs.Size() == rhs.Size());
+    if constexpr (kHasSimdKernels<T>) {
+        return DispatchSimd<T>(level, [&](auto kernels) {
+            return decltype(kernels)::Dot(lhs.begin(), rhs.begin(), lhs.Size());
+        });
+    } else {
+        SumType<T> sum{};
+        for (size_t i = 0; i < lhs.Size(); ++i) {
+            sum += static_cast<SumType<T>>(lhs[i]) * static_cast<SumType<T>>(rhs[i]);
+        }
+        return sum;
+    }
+}
+
+// Оставляет в векторе только элементы x, для которых x op value истинно, сохраняя их порядок.
+// Возвращает новый размер
+template <typename T, typename... Params>
+size_t CompactWhere(Vector<T, Params...>& v, CompareOp op, const T& value, SimdLevel level = DetectSimdLevel()) {
+    size_t kept = 0;
+    if constexpr (kHasSimdKernels<T>) {
+        kept = DispatchSimd<T>(level, [&](auto kernels) {
+            using K = decltype(kernels);
+            switch (op) {
+            case CompareOp::kEqual:
+                return K::template Compact<CompareOp::kEqual>(v.begin(), v.Size(), value);
+            case CompareOp::kNotEqual:
+                return K::template Compact<CompareOp::kNotEqual>(v.begin(), v.Size(), value);
+            case CompareOp::kLess:
+                return K::template Compact<CompareOp::kLess>(v.begin(), v.Size(), value);
+            case CompareOp::kLessEqual:
+                return K::template Compact<CompareOp::kLessEqual>(v.begin(), v.Size(), value);
+            case CompareOp::kGreater:
+                return K::template Compact<CompareOp::kGreater>(v.begin(), v.Size(), value);
+            default:
+                return K::template Compact<CompareOp::kGreaterEqual>(v.begin(), v.Size(), value);
+            }
+        });
+    } else {
+        for (size_t i = 0; i < v.Size(); ++i) {
+            bool keep = false;
+            switch (op) {
+            case CompareOp::kEqual:
+                keep = Compare<CompareOp::kEqual>(v[i], value);
+                break;
+            case CompareOp::kNotEqual:
+                keep = Compare<CompareOp::kNotEqual>(v[i], value);
+                break;
+            case CompareOp::kLess:
+                keep = Compare<CompareOp::kLess>(v[i], value);
+                break;
+            case CompareOp::kLessEqual:
+                keep = Compare<CompareOp::kLessEqual>(v[i], value);
+                break;
+            case CompareOp::kGreater:
+                keep = Compare<CompareOp::kGreater>(v[i], value);
+                break;
+            default:
+                keep = Compare<CompareOp::kGreaterEqual>(v[i], value);
+                break;
+            }
+            if (keep) {
+                if (kept != i) {
+                    v[kept] = std::move(v[i]);
+                }
+                ++kept;
+            }
+        }
+    }
+    v.Resize(kept);
+    return kept;
+}
@@ -0,0 +1,266 @@
+#pragma once
+#include "vector.h"
+#include "vector_algorithms.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Ленивые поэлементные выражения над Vector арифметических типов. Операторы +, -, *, /
+// и функции Fma, Less/Greater/..., Select не считают ничего сами, а строят небольшое
+// дерево со ссылками на операнды; присваивание Vector вычисляет всё дерево одним циклом
+// без промежуточных векторов, который компилятор векторизует (GCC — начиная с -O3, см.
+// Vector::EvaluateInto):
+//
+//     Vector<float> score;
+//     score = weight * feature + bias;                   // один проход, ноль временных буферов
+//     score = Select(Greater(score, 0.0f), score, 0.0f);  // ReLU на месте
+//     score = score * 2 + bias;                           // операнд может совпадать с результатом
+//
+// Выражение хранит указатели на данные векторов, поэтому его не сохраняют в auto
+// дольше, чем живут операнды, и не меняют операнды до присваивания. Размеры векторов
+// в одном выражении должны совпадать; скаляр размножается на любую длину.
+
+namespace vector_expr {
+
+template <typename V>
+inline constexpr bool kIsArithmeticVector = false;
+
+template <typename T, typename Alloc, typename Growth, typename Stats, typename Shrink>
+inline constexpr bool kIsArithmeticVector<Vector<T, Alloc, Growth, Stats, Shrink>> = std::is_arithmetic_v<T>;
+
+// Лист дерева: элементы вектора
+template <typename T>
+class Terminal {
+public:
+    using IsVectorExpression = void;
+    static constexpr bool kIsScalar = false;
+
+    constexpr Terminal(const T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    constexpr T operator[](size_t index) const noexcept {
+        return data_[index];
+    }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+// Скаляр, одинаковый для всех позиций. Самостоятельным выражением не является: размер
+// задают векторные операнды
+template <typename T>
+class Scalar {
+public:
+    static constexpr bool kIsScalar = true;
+
+    constexpr explicit Scalar(T value) noexcept
+        : value_(value) {
+    }
+
+    constexpr T operator[](size_t) const noexcept {
+        return value_;
+    }
+
+private:
+    T value_;
+};
+
+// Размер узла по первому нескалярному операнду; размеры остальных должны совпадать
+template <typename First, typename... Rest>
+constexpr size_t SizeOf(const First& first, const Rest&... rest) noexcept {
+    if constexpr (First::kIsScalar) {
+        return SizeOf(rest...);
+    } else {
+        [[maybe_unused]] const auto same_size = [&first](const auto& operand) {
+            if constexpr (std::remove_cvref_t<decltype(operand)>::kIsScalar) {
+                return true;
+            } else {
+                return operand.Size() == first.Size();
+            }
+        };
+        assert((same_size(rest) && ...));
+        return first.Size();
+    }
+}
+
+template <typename Op, typename... Operands>
+class Node {
+public:
+    using IsVectorExpression = void;
+    static constexpr bool kIsScalar = false;
+
+    constexpr explicit Node(const Operands&... operands) noexcept
+        : operands_(operands...) {
+    }
+
+    constexpr size_t Size() const noexcept {
+        return std::apply(
+            [](const auto&... operands) {
+                return SizeOf(operands...);
+            },
+            operands_);
+    }
+
+    constexpr auto operator[](size_t index) const noexcept {
+        return std::apply(
+            [index](const auto&... operands) {
+                return Op{}(operands[index]...);
+            },
+            operands_);
+    }
+
+private:
+    std::tuple<Operands...> operands_;
+};
+
+struct Negate {
+    template <typename T>
+    constexpr auto operator()(T value) const noexcept {
+        return -value;
+    }
+};
+
+// a * b + c. std::fma без аппаратной поддержки — вызов библиотеки, который не
+// векторизуется, поэтому здесь обычное выражение: при -mfma (или -march с FMA)
+// компилятор сжимает его в одну инструкцию
+struct MultiplyAdd {
+    template <typename A, typename B, typename C>
+    constexpr auto operator()(A a, B b, C c) const noexcept {
+        return a * b + c;
+    }
+};
+
+template <CompareOp Op>
+struct CompareWith {
+    template <typename A, typename B>
+    constexpr bool operator()(A a, B b) const noexcept {
+        using Common = std::common_type_t<A, B>;
+        return Compare<Op, Common>(static_cast<Common>(a), static_cast<Common>(b));
+    }
+};
+
+// Условное присваивание вместо перехода: векторизуется в blend
+struct Choose {
+    template <typename A, typename B>
+    constexpr auto operator()(bool mask, A a, B b) const noexcept {
+        using Result = std::common_type_t<A, B>;
+        return mask ? static_cast<Result>(a) : static_cast<Result>(b);
+    }
+};
+
+// Векторы и узлы выражений — выражения, арифметические значения — скаляры
+template <typename X>
+concept Operand = VectorExpression<X> || kIsArithmeticVector<X> || std::is_arithmetic_v<X>;
+
+template <typename... Xs>
+concept HasVectorOperand = (Operand<Xs> && ...) && (!std::is_arithmetic_v<Xs> || ...);
+
+template <typename X>
+constexpr auto Wrap(const X& x) noexcept {
+    if constexpr (kIsArithmeticVector<X>) {
+        return Terminal<typename X::value_type>(x.begin(), x.Size());
+    } else if constexpr (std::is_arithmetic_v<X>) {
+        return Scalar<X>(x);
+    } else {
+        return x;
+    }
+}
+
+template <typename Op, typename... Xs>
+constexpr auto MakeNode(const Xs&... xs) noexcept {
+    return Node<Op, decltype(Wrap(xs))...>(Wrap(xs)...);
+}
+
+}  // namespace vector_expr
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto operator+(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<std::plus<>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto operator-(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<std::minus<>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto operator*(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<std::multiplies<>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto operator/(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<std::divides<>>(lhs, rhs);
+}
+
+template <typename X>
+    requires vector_expr::HasVectorOperand<X>
+constexpr auto operator-(const X& x) noexcept {
+    return vector_expr::MakeNode<vector_expr::Negate>(x);
+}
+
+template <typename A, typename B, typename C>
+    requires vector_expr::HasVectorOperand<A, B, C>
+constexpr auto Fma(const A& a, const B& b, const C& c) noexcept {
+    return vector_expr::MakeNode<vector_expr::MultiplyAdd>(a, b, c);
+}
+
+// Сравнения дают выражения из bool. Они названы функциями, как CompareOp в vector_algorithms.h:
+// v == w у контейнера читается как сравнение векторов целиком, а не поэлементная маска
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto Equal(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<vector_expr::CompareWith<CompareOp::kEqual>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto NotEqual(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<vector_expr::CompareWith<CompareOp::kNotEqual>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto Less(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<vector_expr::CompareWith<CompareOp::kLess>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto LessEqual(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<vector_expr::CompareWith<CompareOp::kLessEqual>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto Greater(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<vector_expr::CompareWith<CompareOp::kGreater>>(lhs, rhs);
+}
+
+template <typename L, typename R>
+    requires vector_expr::HasVectorOperand<L, R>
+constexpr auto GreaterEqual(const L& lhs, const R& rhs) noexcept {
+    return vector_expr::MakeNode<vector_expr::CompareWith<CompareOp::kGreaterEqual>>(lhs, rhs);
+}
+
+// mask ? a : b поэлементно; mask — выражение из сравнений
+template <typename M, typename A, typename B>
+    requires VectorExpression<M> && vector_expr::HasVectorOperand<M, A, B>
+constexpr auto Select(const M& mask, const A& a, const B& b) noexcept {
+    return vector_expr::MakeNode<vector_expr::Choose>(mask, a, b);
+}
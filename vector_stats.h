@@ -0,0 +1,147 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+
+// Счётчики одного места создания векторов (или всех неразмеченных векторов)
+struct VectorStatsCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+    std::atomic<uint64_t> growths{0};
+    std::atomic<uint64_t> moved_elements{0};
+    std::atomic<uint64_t> copied_elements{0};
+    std::atomic<uint64_t> destroyed_vectors{0};
+    std::atomic<uint64_t> size_at_destroy{0};
+    std::atomic<uint64_t> capacity_at_destroy{0};
+
+    // Доля занятой вместимости по всем уничтоженным векторам
+    double FillRatio() const noexcept {
+        const uint64_t capacity = capacity_at_destroy.load(std::memory_order_relaxed);
+        return capacity == 0 ? 1.0
+                             : static_cast<double>(size_at_destroy.load(std::memory_order_relaxed)) / capacity;
+    }
+};
+
+// Политика статистики, которая считает выделения памяти, рост, перенесённые
+// и скопированные при переезде элементы и заполненность вместимости при уничтожении.
+// Векторы, созданные с выделением памяти (по размеру, из диапазона, копией), относятся
+// к строке своего создания; созданные пустыми без SetStatsSite() попадают в общую
+// запись "<unattributed>". Перемещённый вектор передаёт место новому владельцу, а сам
+// больше ничего не учитывает.
+//
+//     using TrackedVector = Vector<int, std::allocator<int>, DoublingGrowth, CountingVectorStats>;
+//     TrackedVector v;
+//     v.SetStatsSite();
+//     ...
+//     CountingVectorStats::Report(std::cerr);
+class CountingVectorStats {
+public:
+    // counters == nullptr — отвязанное место, которое ничего не учитывает
+    struct Site {
+        VectorStatsCounters* counters = &Unattributed();
+    };
+
+    static constexpr Site DetachedSite() noexcept {
+        return {nullptr};
+    }
+
+    static Site MakeSite(const std::source_location& location) {
+        std::string key = std::string(location.file_name()) + ":" + std::to_string(location.line());
+        std::lock_guard guard(Registry().mutex);
+        auto& counters = Registry().sites[key];
+        if (!counters) {
+            counters = std::make_unique<VectorStatsCounters>();
+        }
+        return {counters.get()};
+    }
+
+    static void OnAllocate(Site& site, size_t bytes) noexcept {
+        if (site.counters == nullptr) {
+            return;
+        }
+        site.counters->allocations.fetch_add(1, std::memory_order_relaxed);
+        site.counters->allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void OnGrow(Site& site, size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+        if (site.counters == nullptr) {
+            return;
+        }
+        site.counters->growths.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void OnRelocate(Site& site, size_t moved, size_t copied) noexcept {
+        if (site.counters == nullptr) {
+            return;
+        }
+        site.counters->moved_elements.fetch_add(moved, std::memory_order_relaxed);
+        site.counters->copied_elements.fetch_add(copied, std::memory_order_relaxed);
+    }
+
+    static void OnDestroy(Site& site, size_t size, size_t capacity) noexcept {
+        if (site.counters == nullptr) {
+            return;
+        }
+        site.counters->destroyed_vectors.fetch_add(1, std::memory_order_relaxed);
+        site.counters->size_at_destroy.fetch_add(size, std::memory_order_relaxed);
+        site.counters->capacity_at_destroy.fetch_add(capacity, std::memory_order_relaxed);
+    }
+
+    // Счётчики места site или общей записи, если site пуст
+    static const VectorStatsCounters& Get(const std::string& site = {}) {
+        if (site.empty()) {
+            return Unattributed();
+        }
+        std::lock_guard guard(Registry().mutex);
+        auto it = Registry().sites.find(site);
+        static const VectorStatsCounters empty;
+        return it == Registry().sites.end() ? empty : *it->second;
+    }
+
+    // Печатает по строке на каждое место создания
+    static void Report(std::ostream& out) {
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << "site allocations bytes growths moved copied vectors fill\n";
+        Print(out, "<unattributed>", Unattributed());
+        {
+            std::lock_guard guard(Registry().mutex);
+            for (const auto& [site, counters] : Registry().sites) {
+                Print(out, site, *counters);
+            }
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+    struct SiteRegistry {
+        std::mutex mutex;
+        std::map<std::string, std::unique_ptr<VectorStatsCounters>> sites;
+    };
+
+    static SiteRegistry& Registry() {
+        static SiteRegistry registry;
+        return registry;
+    }
+
+    static VectorStatsCounters& Unattributed() {
+        static VectorStatsCounters counters;
+        return counters;
+    }
+
+    static void Print(std::ostream& out, const std::string& site, const VectorStatsCounters& counters) {
+        out << site << ' ' << counters.allocations.load() << ' ' << counters.allocated_bytes.load() << ' '
+            << counters.growths.load() << ' ' << counters.moved_elements.load() << ' '
+            << counters.copied_elements.load() << ' ' << counters.destroyed_vectors.load() << ' '
+            << std::fixed << std::setprecision(3) << counters.FillRatio() << '\n';
+    }
+};